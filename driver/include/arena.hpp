@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_set>
+#include <vector>
+#include <wordle.hpp>
+#include <resources.hpp>
+
+// Interns solver states so each distinct state is stored once
+// and referred to by a dense 32-bit id.
+// Guesses are referred to by their index in the guess list.
+class StateArena {
+public:
+  using Word = wordle::Word<word_length>;
+  using State = wordle::State<word_length>;
+  using Response = wordle::Response<word_length>;
+  using Id = uint32_t;
+
+  // Returned by transition() when the response is nonsensical
+  static constexpr Id invalid = UINT32_MAX;
+
+  // The initial state is always id 0
+  explicit StateArena(std::span<const Word> guesses);
+  // The lookup set points back into the arena
+  StateArena(const StateArena&) = delete;
+  StateArena& operator=(const StateArena&) = delete;
+
+  // Returns the id of the state, adding it if it's new
+  Id intern(const State& s);
+  const State& get(Id id) const { return states[id]; }
+  size_t size() const { return states.size(); }
+
+  // Id of get(id) updated with guesses[word_idx] and the response
+  // Not memoized: the solver expands each (state, guess) pair only once
+  Id transition(Id id, uint32_t word_idx, const Response& r);
+
+private:
+  // Hashes ids through the arena so the set doesn't duplicate states
+  struct IdHash {
+    using is_transparent = void;
+    const std::vector<State> *states;
+    size_t operator()(Id id) const noexcept { return std::hash<State>{}((*states)[id]); }
+    size_t operator()(const State& s) const noexcept { return std::hash<State>{}(s); }
+  };
+  struct IdEqual {
+    using is_transparent = void;
+    const std::vector<State> *states;
+    bool operator()(Id a, Id b) const noexcept { return a == b; }
+    bool operator()(Id a, const State& b) const noexcept { return (*states)[a] == b; }
+    bool operator()(const State& a, Id b) const noexcept { return a == (*states)[b]; }
+  };
+
+  std::span<const Word> guesses;
+  std::vector<State> states;
+  std::unordered_set<Id, IdHash, IdEqual> ids;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+#include <wordle.hpp>
+#include <resources.hpp>
+
+// Absurdle on several boards at once (Dordle/Quordle-style):
+// every guess is played on all of the unsolved boards, and each board
+// gives the response that keeps the most secrets alive.
+// As in Quordle, the boards have distinct secrets: a board only gives a
+// response if every board can still end on a different answer.
+//
+// Boards are kept as candidate lists rather than States. Each guess is
+// scored against the answer list once, and every board's candidates are
+// bucketed by that shared response code, in parallel across boards.
+// The boards then pick their responses in order, keeping a matching of
+// boards to distinct candidate answers up to date.
+class MultiAbsurd {
+public:
+  using Word = wordle::Word<word_length>;
+  using Response = wordle::Response<word_length>;
+
+  explicit MultiAbsurd(
+    size_t boards,
+    std::span<const Word> answers = answerlist,
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency()));
+
+  // Plays the guess on every board
+  // Boards that were already solved get nullopt
+  std::vector<std::optional<Response>> respond(const Word& guess);
+
+  size_t boards() const { return candidates.size(); }
+  bool solved(size_t board) const { return done[board] != 0; }
+  bool all_solved() const { return std::all_of(done.begin(), done.end(), [](uint8_t d) { return d != 0; }); }
+  // The secrets still possible on the board
+  size_t remaining(size_t board) const { return candidates[board].size(); }
+  // A secret still possible on the board, distinct from the other boards' examples
+  const Word& example(size_t board) const { return answers[matched[board]]; }
+
+private:
+  static constexpr uint32_t none = UINT32_MAX;
+
+  // Tries to give `board` a distinct answer, moving other boards along
+  // an augmenting path if needed. Only changes the matching on success.
+  bool augment(uint32_t board, std::vector<uint8_t>& seen);
+
+  std::span<const Word> answers;
+  unsigned threads;
+  // Answer indices still possible on each board
+  std::vector<std::vector<uint32_t>> candidates;
+  // Answer index of each board, and the board of each answer (or none)
+  std::vector<uint32_t> matched;
+  std::vector<uint32_t> owner;
+  std::vector<uint8_t> done;
+  // Response code of the current guess against each answer
+  std::vector<uint16_t> codes;
+  // Tie-breaks by response code: fewer greens, then fewer colors
+  std::vector<uint8_t> greens;
+  std::vector<uint8_t> colors;
+  uint16_t all_green;
+};
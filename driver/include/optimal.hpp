@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+#include <wordle.hpp>
+#include <resources.hpp>
+
+// Solves standard Wordle: finds the decision tree that minimizes the
+// expected number of guesses against a uniformly random secret from the
+// answer list, breaking ties by the worst case.
+
+struct OptimalConfig {
+  std::span<const wordle::Word<word_length>> guesses = wordlist;
+  std::span<const wordle::Word<word_length>> answers = answerlist;
+  // No secret may take more than this many guesses
+  unsigned max_depth = 6;
+  // Only try the most promising guesses at each node (0 tries all of them)
+  // Anything but 0 gives a heuristic rather than an optimal tree
+  size_t max_guesses = 0;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+// Compact decision tree, walked in O(1) per turn:
+// each node stores its guess and a bitset of the responses that lead to
+// another node, and children are found by ranking the response in the bitset.
+class DecisionTree {
+public:
+  using Word = wordle::Word<word_length>;
+  using Response = wordle::Response<word_length>;
+  using Node = uint32_t;
+
+  // Returned by next() once the secret has been guessed
+  // (or for a response no secret gives)
+  static constexpr Node none = UINT32_MAX;
+
+  Node root() const { return nodes.empty() ? none : 0; }
+  const Word& guess(Node n) const { return nodes[n].guess; }
+  Node next(Node n, const Response& r) const;
+  size_t size() const { return nodes.size(); }
+
+  std::ostream& serialize(std::ostream& out) const;
+  // Returns an empty tree if the input isn't a tree for this word length
+  static DecisionTree deserialize(std::istream& in);
+
+private:
+  friend class OptimalBuilder;
+  static constexpr size_t mask_words = (Response::combinations + 63) / 64;
+  struct NodeData {
+    Word guess;
+    // Index of the child for the lowest present response
+    uint32_t first_child;
+    std::array<uint64_t, mask_words> present;
+    // Number of present responses in the preceding mask words
+    std::array<uint16_t, mask_words> rank;
+  };
+  std::vector<NodeData> nodes;
+};
+
+struct OptimalResult {
+  DecisionTree tree;
+  // Sum over all answers of the guesses needed to find them
+  uint64_t total_guesses;
+  unsigned worst_case;
+};
+
+// Returns nullopt if no tree solves every answer within max_depth guesses
+std::optional<OptimalResult> solve_optimal(const OptimalConfig& config);
@@ -1,7 +1,16 @@
 
 #include <iostream>
 #include <wordle.hpp>
+#include <resources.hpp>
 
+// The solver guesses from `wordlist` and only `answerlist` can be the secret,
+// both fixed when the driver is configured (WORDLE_WORDLIST, WORDLE_ANSWERS)
+
+// Cache files are tagged with the dictionary they were computed for
 void save_caches(std::ostream& out);
-void load_caches(std::istream& in);
+// Throws if the file was computed for a different dictionary, unless
+// `incremental` is set, in which case only the entries the changed
+// words could affect are dropped, to be re-solved by run()
+void load_caches(std::istream& in, bool incremental = false);
+// Solves from the root, reusing any loaded caches
 void run();
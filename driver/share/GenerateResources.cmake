@@ -1,14 +1,53 @@
-
-file(STRINGS ${INPUT_FILE} words)
+# Only words of the configured length are compiled in,
+# so one wordlist file can serve every supported length
+file(STRINGS ${INPUT_FILE} all_words)
+set(words)
+foreach(word IN LISTS all_words)
+    string(LENGTH "${word}" len)
+    if(len EQUAL WORD_LENGTH)
+        list(APPEND words "${word}")
+    endif()
+endforeach()
 list(LENGTH words num_words)
+if(num_words EQUAL 0)
+    message(FATAL_ERROR "No ${WORD_LENGTH}-letter words in ${INPUT_FILE}")
+endif()
+
+# Possible secrets, which default to every allowed guess
+if(ANSWERS_FILE)
+    file(STRINGS ${ANSWERS_FILE} all_answers)
+    set(answers)
+    foreach(word IN LISTS all_answers)
+        string(LENGTH "${word}" len)
+        if(len EQUAL WORD_LENGTH)
+            list(FIND words "${word}" idx)
+            if(idx EQUAL -1)
+                message(FATAL_ERROR "Answer ${word} is not in ${INPUT_FILE}")
+            endif()
+            list(APPEND answers "${word}")
+        endif()
+    endforeach()
+else()
+    set(answers ${words})
+endif()
+list(LENGTH answers num_answers)
+if(num_answers EQUAL 0)
+    message(FATAL_ERROR "No ${WORD_LENGTH}-letter words in ${ANSWERS_FILE}")
+endif()
 
 string(CONFIGURE [[
 // This file is auto-generated, do not modify!
 #pragma once
 #include <array>
+#include <cstddef>
 #include <wordle.hpp>
 
-extern const std::array<wordle::Word, @num_words@> wordlist;
+inline constexpr size_t word_length = @WORD_LENGTH@;
+
+// Every allowed guess
+extern const std::array<wordle::Word<word_length>, @num_words@> wordlist;
+// Every possible secret, a subset of the wordlist
+extern const std::array<wordle::Word<word_length>, @num_answers@> answerlist;
 ]] header)
 file(WRITE ${OUTPUT_HEADER} "${header}")
 
@@ -18,20 +57,28 @@ string(CONFIGURE [[
 #include <wordle.hpp>
 #include <resources.hpp>
 
-const std::array<wordle::Word, @num_words@> wordlist = {
+const std::array<wordle::Word<word_length>, @num_words@> wordlist = {
 ]] file_header)
 file(WRITE ${OUTPUT_FILE} "${file_header}")
 
-math(EXPR last_idx "${num_words} - 1")
-list(GET words ${last_idx} last_word)
-
-foreach(word IN LISTS words)
-    file(APPEND ${OUTPUT_FILE} "    wordle::Word(\"${word}\")")
-    if(NOT word STREQUAL last_word)
-        file(APPEND ${OUTPUT_FILE} ",")
-    endif()
-    file(APPEND ${OUTPUT_FILE} "\n")
-endforeach()
+# Writes the words as the body of a C++ array initializer
+function(append_words list)
+    list(LENGTH ${list} count)
+    math(EXPR last_idx "${count} - 1")
+    set(idx 0)
+    foreach(word IN LISTS ${list})
+        file(APPEND ${OUTPUT_FILE} "    wordle::Word<word_length>(\"${word}\")")
+        if(idx LESS last_idx)
+            file(APPEND ${OUTPUT_FILE} ",")
+        endif()
+        file(APPEND ${OUTPUT_FILE} "\n")
+        math(EXPR idx "${idx} + 1")
+    endforeach()
+endfunction()
 
+append_words(words)
 file(APPEND ${OUTPUT_FILE} "};\n")
 
+file(APPEND ${OUTPUT_FILE} "\nconst std::array<wordle::Word<word_length>, ${num_answers}> answerlist = {\n")
+append_words(answers)
+file(APPEND ${OUTPUT_FILE} "};\n")
@@ -0,0 +1,27 @@
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <wordle.hpp>
+#include <resources.hpp>
+#include <arena.hpp>
+
+StateArena::StateArena(std::span<const Word> guesses)
+    : guesses(guesses), ids(0, IdHash{&states}, IdEqual{&states}) {
+    intern(State{});
+}
+
+StateArena::Id StateArena::intern(const State& s) {
+    if (auto it = ids.find(s); it != ids.end()) {
+        return *it;
+    }
+    assert(states.size() < invalid);
+    Id id = static_cast<Id>(states.size());
+    states.push_back(s);
+    ids.insert(id);
+    return id;
+}
+
+StateArena::Id StateArena::transition(Id id, uint32_t word_idx, const Response& r) {
+    State s = states[id];
+    return s.update(guesses[word_idx], r) ? intern(s) : invalid;
+}
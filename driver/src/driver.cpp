@@ -1,42 +1,76 @@
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <wordle.hpp>
+#include <trace.hpp>
 #include <resources.hpp>
 #include <solver.hpp>
+#include <optimal.hpp>
+#include <multiboard.hpp>
 
-int main() {
-    run();
+using Word = wordle::Word<word_length>;
+using Response = wordle::Response<word_length>;
+using State = wordle::State<word_length>;
+
+int driver_main(int argc, char *argv[]);
+int optimal_main(int argc, char *argv[]);
+int multi_main(int argc, char *argv[]);
+int resume_main(int argc, char *argv[]);
+
+int main(int argc, char *argv[]) {
+    int ret = 0;
+    if (argc < 2) {
+        // Solve absurdle
+        run();
+    } else if (std::strcmp(argv[1], "optimal") == 0) {
+        ret = optimal_main(argc, argv);
+    } else if (std::strcmp(argv[1], "multi") == 0) {
+        ret = multi_main(argc, argv);
+    } else if (std::strcmp(argv[1], "resume") == 0) {
+        ret = resume_main(argc, argv);
+    } else {
+        ret = driver_main(argc, argv);
+    }
+
+#ifdef WORDLE_TRACE
+    // Chrome/Perfetto trace of the run
+    const char *trace_file = std::getenv("WORDLE_TRACE_FILE");
+    std::ofstream trace(trace_file != nullptr ? trace_file : "trace.json", std::ios_base::trunc);
+    wordle::trace::flush(trace);
+#endif
+    return ret;
 }
 
-static std::optional<wordle::Word> input();
+static std::optional<Word> input();
 
 class Strategy {
 public:
   Strategy() {}
   virtual ~Strategy() {};
-  virtual wordle::Response respond(const wordle::State& state, const wordle::Word& guess) = 0;
+  virtual Response respond(const State& state, const Word& guess) = 0;
 };
 
 class Standard : public Strategy {
 public:
   Standard();
-  wordle::Response respond(const wordle::State&, const wordle::Word& guess) override;
-  wordle::Word get_secret() const { return secret; }
+  Response respond(const State&, const Word& guess) override;
+  Word get_secret() const { return secret; }
 private:
-  wordle::Word secret;
+  Word secret;
 };
 
 class Absurd : public Strategy {
 public:
   Absurd();
-  wordle::Response respond(const wordle::State&, const wordle::Word& guess) override;
+  Response respond(const State&, const Word& guess) override;
 };
 
 int driver_main(int argc, char *argv[]) {
@@ -44,7 +78,7 @@ int driver_main(int argc, char *argv[]) {
 
   // Argument parsing
   auto usage = [progname=argv[0]]() {
-    std::cerr << "Usage: " << progname << " <strategy>" << std::endl;
+    std::cerr << "Usage: " << progname << " <strategy> [decision tree]" << std::endl;
   };
   if (argc < 2) {
     usage();
@@ -61,12 +95,27 @@ int driver_main(int argc, char *argv[]) {
     return 1;
   }
 
-  wordle::State state{};
-  std::vector<std::pair<wordle::Word, wordle::Response>> history;
+  // Suggests guesses by walking a tree from `driver optimal`
+  DecisionTree tree;
+  if (argc >= 3) {
+    std::ifstream in(argv[2], std::ios_base::binary);
+    tree = DecisionTree::deserialize(in);
+    if (tree.size() == 0) {
+      std::cerr << "Invalid decision tree: " << argv[2] << std::endl;
+      return 1;
+    }
+  }
+  auto node = tree.root();
+
+  State state{};
+  std::vector<std::pair<Word, Response>> history;
   while (true) {
     for (auto [g, r] : history) {
       r.write_ansi(std::cout, g) << std::endl;
     }
+    if (node != DecisionTree::none) {
+      std::cout << "Suggested: " << tree.guess(node) << std::endl;
+    }
     auto w = input();
     if (!w.has_value()) {
       return 1;
@@ -74,6 +123,9 @@ int driver_main(int argc, char *argv[]) {
     auto guess = w.value();
     auto response = strat->respond(state, guess);
     history.emplace_back(guess, response);
+    if (node != DecisionTree::none) {
+      node = guess == tree.guess(node) ? tree.next(node, response) : DecisionTree::none;
+    }
     state.update(guess, response);
     std::clog << state << std::endl;
 
@@ -92,11 +144,11 @@ int driver_main(int argc, char *argv[]) {
     }
 
     auto possible = std::find_if(
-        wordlist.begin(),
-        wordlist.end(), 
-        [&](const wordle::Word& w) { return state.matches(w); });
+        answerlist.begin(),
+        answerlist.end(),
+        [&](const Word& w) { return state.matches(w); });
 
-    if (possible == wordlist.end()) {
+    if (possible == answerlist.end()) {
       std::cout << "No possible words!!" << std::endl;
     } else {
       std::cout << "Possible: " << *possible << std::endl;
@@ -106,9 +158,126 @@ int driver_main(int argc, char *argv[]) {
   return 0;
 }
 
-static std::optional<wordle::Word> input() {
+int optimal_main(int argc, char *argv[]) {
+  auto usage = [progname=argv[0]]() {
+    std::cerr << "Usage: " << progname << " optimal <output tree> [max depth] [max guesses per node]" << std::endl;
+  };
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  OptimalConfig config;
+  if (argc >= 4) {
+    int depth = std::atoi(argv[3]);
+    if (depth < 1) {
+      std::cerr << "Max depth must be at least 1" << std::endl;
+      return 1;
+    }
+    config.max_depth = depth;
+  }
+  if (argc >= 5) {
+    int guesses = std::atoi(argv[4]);
+    if (guesses < 0) {
+      std::cerr << "Max guesses per node can't be negative" << std::endl;
+      return 1;
+    }
+    config.max_guesses = guesses;
+  }
+
+  auto result = solve_optimal(config);
+  if (!result.has_value()) {
+    std::cout << "No decision tree solves every answer in " << config.max_depth << " guesses" << std::endl;
+    return 2;
+  }
+  std::cout << "Expected guesses: " << double(result->total_guesses) / config.answers.size() << std::endl;
+  std::cout << "Worst case: " << result->worst_case << std::endl;
+  std::cout << "Nodes: " << result->tree.size() << std::endl;
+
+  std::ofstream out(argv[2], std::ios_base::binary | std::ios_base::trunc);
+  result->tree.serialize(out);
+  return 0;
+}
+
+int multi_main(int argc, char *argv[]) {
+  auto usage = [progname=argv[0]]() {
+    std::cerr << "Usage: " << progname << " multi <boards>" << std::endl;
+  };
+  if (argc < 3 || std::atoi(argv[2]) <= 0) {
+    usage();
+    return 1;
+  }
+
+  MultiAbsurd game(std::atoi(argv[2]));
+  std::vector<Word> guesses;
+  std::vector<std::vector<std::optional<Response>>> history;
+  while (!game.all_solved()) {
+    for (size_t i = 0; i < guesses.size(); i++) {
+      for (size_t b = 0; b < game.boards(); b++) {
+        if (history[i][b].has_value()) {
+          history[i][b]->write_ansi(std::cout, guesses[i]);
+        } else {
+          std::cout << std::string(word_length, ' ');
+        }
+        std::cout << ' ';
+      }
+      std::cout << std::endl;
+    }
+    for (size_t b = 0; b < game.boards(); b++) {
+      if (!game.solved(b)) {
+        std::clog << "Board " << b + 1 << ": " << game.remaining(b)
+                  << " possible, ex. " << game.example(b) << std::endl;
+      }
+    }
+
+    auto w = input();
+    if (!w.has_value()) {
+      return 1;
+    }
+    guesses.push_back(w.value());
+    history.push_back(game.respond(w.value()));
+  }
+  std::cout << "Good job! Solved " << game.boards() << " boards in " << guesses.size() << " guesses" << std::endl;
+  return 0;
+}
+
+int resume_main(int argc, char *argv[]) {
+  auto usage = [progname=argv[0]]() {
+    std::cerr << "Usage: " << progname << " resume [--incremental]" << std::endl;
+  };
+  bool incremental = false;
+  if (argc >= 3) {
+    if (std::strcmp(argv[2], "--incremental") != 0) {
+      usage();
+      return 1;
+    }
+    incremental = true;
+  }
+
+  // Picks the absurdle solve back up from the caches it saved
+  std::ifstream in("log.bin", std::ios_base::binary);
+  if (!in) {
+    std::cerr << "No log.bin to resume from" << std::endl;
+    return 1;
+  }
+  try {
+    load_caches(in, incremental);
+  } catch (std::runtime_error *e) {
+    std::cerr << "Can't resume: " << e->what() << std::endl;
+    if (!incremental) {
+      std::cerr << "Pass --incremental to re-solve only what the dictionary change affects" << std::endl;
+    }
+    delete e;
+    return 2;
+  }
+  in.close();
+  run();
+  return 0;
+}
+
+static std::optional<Word> input() {
   std::string line;
-  wordle::Word guess;
+  Word guess;
   while (true) {
     std::cout << "Enter guess: ";
     std::getline(std::cin, line);
@@ -116,10 +285,10 @@ static std::optional<wordle::Word> input() {
       return std::nullopt;
     }
 
-    if (line.size() > 5) {
+    if (line.size() > word_length) {
       std::cout << "Invalid line: too many characters" << std::endl;
       continue;
-    } else if (line.size() < 5) {
+    } else if (line.size() < word_length) {
       std::cout << "Invalid line: too few characters" << std::endl;
       continue;
     }
@@ -141,72 +310,59 @@ static std::optional<wordle::Word> input() {
 }
 
 Standard::Standard() {
-  secret = wordlist[std::rand() % wordlist.size()];
+  secret = answerlist[std::rand() % answerlist.size()];
   std::clog << "Secret: " << secret << std::endl;
 }
 
-wordle::Response Standard::respond(const wordle::State& state, const wordle::Word& guess) {
+Response Standard::respond(const State& state, const Word& guess) {
+  WORDLE_TRACE_SPAN("Standard::respond");
   if (!state.matches(secret)) {
     throw new std::runtime_error("State doesn't match secret");
   }
-  wordle::Response r{};
-  std::array<uint8_t, 26> s_occurs{};
-  for (size_t i = 0; i < secret.size(); i++) {
-    if (secret[i] == guess[i]) {
-      r[i] = wordle::Color::GREEN;
-    } else {
-      s_occurs[secret[i]]++;
-    }
-  }
-  for (size_t i = 0; i < secret.size(); i++) {
-    if (r[i] == wordle::Color::GRAY && s_occurs[guess[i]] > 0) {
-      s_occurs[guess[i]]--;
-      r[i] = wordle::Color::YELLOW;
-    }
-  }
-  return r;
+  return Response::score(guess, secret);
 }
 
 Absurd::Absurd() : Strategy() {}
 
-static int response_colors(const wordle::Response& r) {
+static int response_colors(const Response& r) {
   return std::count_if(
     r.begin(), 
     r.end(), 
     [](const wordle::Color& c) { return c != wordle::Color::GRAY; });
 }
 
-static int response_greens(const wordle::Response& r) {
+static int response_greens(const Response& r) {
   return std::count_if(
     r.begin(), 
     r.end(), 
     [](const wordle::Color& c) { return c == wordle::Color::GREEN; });
 }
 
-wordle::Response Absurd::respond(const wordle::State& state, const wordle::Word& guess) {
+Response Absurd::respond(const State& state, const Word& guess) {
+  WORDLE_TRACE_SPAN("Absurd::respond");
   {
-    std::cout << "Wordlist size: " << wordlist.size() << std::endl;
-    auto w = std::find_if(wordlist.begin(), wordlist.end(), [&](const wordle::Word& word) { return state.matches(word); });
-    if (w == wordlist.end())
+    std::cout << "Answer list size: " << answerlist.size() << std::endl;
+    auto w = std::find_if(answerlist.begin(), answerlist.end(), [&](const Word& word) { return state.matches(word); });
+    if (w == answerlist.end())
       throw new std::runtime_error("State has no matches");
     std::clog << "Current state matches something, ex. " << *w << std::endl;
   }
 
-  using T = std::pair<wordle::Response, int>;
+  using T = std::pair<Response, int>;
   std::vector<T> ranks;
-  wordle::Response r;
+  Response r;
   int not_invalid = 0;
   do {
-    wordle::State newstate = state;
+    State newstate = state;
     bool ok = newstate.update(guess, r);
     if (!ok)
       continue;
     not_invalid++;
     int rank =
       std::count_if(
-        wordlist.begin(),
-        wordlist.end(),
-        [&newstate](const wordle::Word& w) {
+        answerlist.begin(),
+        answerlist.end(),
+        [&newstate](const Word& w) {
           return newstate.matches(w);
         });
     if (rank != 0)
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <wordle.hpp>
+#include <trace.hpp>
+#include <resources.hpp>
+#include <multiboard.hpp>
+
+MultiAbsurd::MultiAbsurd(size_t boards, std::span<const Word> answers, unsigned threads)
+    : answers(answers), threads(std::max(1u, threads)), done(boards, 0), codes(answers.size()),
+      greens(Response::combinations), colors(Response::combinations) {
+    if (boards == 0) {
+        throw new std::runtime_error("Need at least one board");
+    }
+    if (answers.size() < boards) {
+        throw new std::runtime_error("Need a distinct answer for every board");
+    }
+    assert(answers.size() < none);
+
+    std::vector<uint32_t> all(answers.size());
+    for (uint32_t i = 0; i < all.size(); i++) {
+        all[i] = i;
+    }
+    candidates.assign(boards, all);
+    matched.resize(boards);
+    owner.assign(answers.size(), none);
+    for (uint32_t b = 0; b < boards; b++) {
+        matched[b] = b;
+        owner[b] = b;
+    }
+
+    Response r;
+    do {
+        auto code = r.code();
+        greens[code] = std::count(r.begin(), r.end(), wordle::Color::GREEN);
+        colors[code] = std::count_if(r.begin(), r.end(), [](wordle::Color c) { return c != wordle::Color::GRAY; });
+    } while (r.next_combination());
+    std::fill(r.begin(), r.end(), wordle::Color::GREEN);
+    all_green = r.code();
+}
+
+std::vector<std::optional<MultiAbsurd::Response>> MultiAbsurd::respond(const Word& guess) {
+    WORDLE_TRACE_SPAN("MultiAbsurd::respond");
+    // The partition of the answers is the same for every board
+    {
+        WORDLE_TRACE_SPAN("score answers");
+        for (size_t i = 0; i < answers.size(); i++) {
+            codes[i] = Response::score(guess, answers[i]).code();
+        }
+    }
+
+    // Every board ranks its responses, in parallel
+    // Same order as Absurd: the biggest bucket, then fewer greens,
+    // then fewer colors, then the first in next_combination() order
+    std::vector<std::vector<uint16_t>> ranked(boards());
+    std::atomic<size_t> next = 0;
+    {
+        std::vector<std::jthread> workers;
+        unsigned n = std::min<size_t>(threads, boards());
+        for (unsigned t = 0; t < n; t++) {
+            workers.emplace_back([&] {
+                std::vector<uint32_t> counts(Response::combinations);
+                for (size_t b; (b = next++) < boards();) {
+                    if (done[b]) {
+                        continue;
+                    }
+                    WORDLE_TRACE_SPAN("rank board responses");
+                    std::fill(counts.begin(), counts.end(), 0);
+                    for (auto a : candidates[b]) {
+                        counts[codes[a]]++;
+                    }
+
+                    auto& order = ranked[b];
+                    for (uint16_t c = 0; c < counts.size(); c++) {
+                        if (counts[c] != 0) {
+                            order.push_back(c);
+                        }
+                    }
+                    std::stable_sort(order.begin(), order.end(), [&](uint16_t x, uint16_t y) {
+                        if (counts[x] != counts[y]) {
+                            return counts[x] > counts[y];
+                        }
+                        if (greens[x] != greens[y]) {
+                            return greens[x] < greens[y];
+                        }
+                        return colors[x] < colors[y];
+                    });
+                }
+            });
+        }
+    }
+
+    // Each board takes its best response that still leaves every board a
+    // distinct answer. One always exists: the bucket of its matched answer.
+    WORDLE_TRACE_SPAN("pick distinct responses");
+    std::vector<std::optional<Response>> responses(boards());
+    std::vector<uint8_t> seen(answers.size());
+    for (uint32_t b = 0; b < boards(); b++) {
+        if (done[b]) {
+            continue;
+        }
+        auto& board = candidates[b];
+        for (auto code : ranked[b]) {
+            if (code != codes[matched[b]]) {
+                // The board's answer would be ruled out, so look for another
+                std::vector<uint32_t> previous = board;
+                std::erase_if(board, [&](uint32_t a) { return codes[a] != code; });
+                uint32_t answer = matched[b];
+                owner[answer] = none;
+                std::fill(seen.begin(), seen.end(), 0);
+                if (!augment(b, seen)) {
+                    owner[answer] = b;
+                    board = std::move(previous);
+                    continue;
+                }
+            } else {
+                std::erase_if(board, [&](uint32_t a) { return codes[a] != code; });
+            }
+            done[b] = code == all_green;
+            responses[b] = Response::from_code(code);
+            break;
+        }
+        assert(responses[b].has_value());
+    }
+    return responses;
+}
+
+bool MultiAbsurd::augment(uint32_t board, std::vector<uint8_t>& seen) {
+    for (auto a : candidates[board]) {
+        if (seen[a]) {
+            continue;
+        }
+        seen[a] = 1;
+        if (owner[a] == none || augment(owner[a], seen)) {
+            owner[a] = board;
+            matched[board] = a;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,505 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <wordle.hpp>
+#include <trace.hpp>
+#include <resources.hpp>
+#include <optimal.hpp>
+
+using Word = wordle::Word<word_length>;
+using Response = wordle::Response<word_length>;
+
+// Branch and bound
+//
+// A node is the set of answers still consistent with the responses so far,
+// stored as sorted answer indices. Its cost is the total number of guesses
+// needed to find every one of those answers, so the expected number of
+// guesses at the root is cost / answers.
+//
+// A guess costs one guess per candidate, plus the cost of each bucket of the
+// partition it induces (the all-green bucket is done). A set of n > 1
+// candidates costs at least 2n - 1: at best one is guessed right away and
+// every other one needs a second guess. Guesses are tried in order of how
+// evenly they split the candidates, and abandoned as soon as their cost
+// plus the lower bounds of the remaining buckets exceeds the best so far.
+//
+// Results are memoized by (depth, candidate set). A result is exact if it is
+// the optimum, otherwise it only records that the optimum exceeds some limit.
+
+namespace {
+using Candidates = std::vector<uint16_t>;
+
+constexpr uint32_t infinite = UINT32_MAX / 2;
+constexpr uint16_t all_green = Response::combinations - 1;
+
+uint32_t lower_bound(size_t n) {
+    return n == 0 ? 0 : 2 * static_cast<uint32_t>(n) - 1;
+}
+
+struct Result {
+    // Total guesses, or a lower bound above the limit if not exact
+    uint32_t total = infinite;
+    uint8_t worst = UINT8_MAX;
+    bool exact = false;
+    // Index into config.guesses
+    uint32_t guess = 0;
+};
+
+// Lower total first, then lower worst case
+bool better(const Result& a, const Result& b) {
+    if (a.total != b.total) {
+        return a.total < b.total;
+    }
+    return a.worst < b.worst;
+}
+
+struct Key {
+    unsigned depth;
+    Candidates candidates;
+    bool operator==(const Key&) const = default;
+};
+
+struct KeyHash {
+    size_t operator()(const Key& k) const noexcept {
+        uint64_t h = 0xcbf29ce484222325ull ^ k.depth;
+        for (auto c : k.candidates) {
+            h = (h ^ c) * 0x100000001b3ull;
+        }
+        return h;
+    }
+};
+
+// Shared between the solver threads, split into shards to limit contention
+class Memo {
+public:
+    std::optional<Result> find(const Key& k) {
+        auto& shard = shard_for(k);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.map.find(k);
+        if (it == shard.map.end()) {
+            return std::nullopt;
+        }
+        return (*it).second;
+    }
+
+    // Keeps exact results, and otherwise the tightest lower bound
+    void store(const Key& k, const Result& r) {
+        auto& shard = shard_for(k);
+        std::unique_lock lock(shard.mutex);
+        auto [it, inserted] = shard.map.try_emplace(k, r);
+        auto& old = (*it).second;
+        if (!inserted && !old.exact && (r.exact || r.total > old.total)) {
+            old = r;
+        }
+    }
+
+private:
+    static constexpr size_t shards = 64;
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<Key, Result, KeyHash> map;
+    };
+    Shard& shard_for(const Key& k) {
+        return data[KeyHash{}(k) % shards];
+    }
+    std::array<Shard, shards> data;
+};
+
+struct Bucket {
+    uint16_t code;
+    Candidates candidates;
+};
+}
+
+class OptimalBuilder {
+public:
+    explicit OptimalBuilder(const OptimalConfig& config);
+    std::optional<OptimalResult> run();
+
+private:
+    Result solve(const Candidates& c, unsigned depth, uint32_t limit);
+    Result evaluate(const Candidates& c, unsigned depth, uint32_t guess, uint32_t limit);
+    std::vector<uint32_t> order_guesses(const Candidates& c);
+    std::vector<Bucket> partition(const Candidates& c, uint32_t guess);
+    DecisionTree build(const Candidates& root, uint32_t guess);
+
+    uint16_t score(uint32_t guess, uint16_t answer) const {
+        return scores[size_t(guess) * config.answers.size() + answer];
+    }
+
+    const OptimalConfig& config;
+    // scores[guess * answers + answer] is the response code
+    std::vector<uint16_t> scores;
+    // Index of each answer in config.guesses
+    std::vector<uint32_t> answer_guess;
+    Memo memo;
+};
+
+OptimalBuilder::OptimalBuilder(const OptimalConfig& config) : config(config) {
+    WORDLE_TRACE_SPAN("OptimalBuilder::OptimalBuilder");
+    assert(config.answers.size() <= UINT16_MAX);
+
+    std::unordered_map<Word, uint32_t> guess_index;
+    for (uint32_t g = 0; g < config.guesses.size(); g++) {
+        guess_index.insert(std::pair(config.guesses[g], g));
+    }
+    for (const auto& a : config.answers) {
+        auto it = guess_index.find(a);
+        if (it == guess_index.end()) {
+            throw new std::runtime_error("Answer is not an allowed guess");
+        }
+        answer_guess.push_back((*it).second);
+    }
+
+    // Precompute every response, split across the threads by guess
+    scores.resize(config.guesses.size() * config.answers.size());
+    std::vector<std::jthread> workers;
+    for (unsigned t = 0; t < config.threads; t++) {
+        workers.emplace_back([this, t] {
+            for (size_t g = t; g < this->config.guesses.size(); g += this->config.threads) {
+                for (size_t a = 0; a < this->config.answers.size(); a++) {
+                    scores[g * this->config.answers.size() + a] =
+                        Response::score(this->config.guesses[g], this->config.answers[a]).code();
+                }
+            }
+        });
+    }
+}
+
+std::vector<Bucket> OptimalBuilder::partition(const Candidates& c, uint32_t guess) {
+    thread_local std::vector<uint16_t> counts(Response::combinations);
+    for (auto a : c) {
+        counts[score(guess, a)]++;
+    }
+
+    std::vector<Bucket> buckets;
+    std::array<int32_t, Response::combinations> slot;
+    for (auto a : c) {
+        uint16_t code = score(guess, a);
+        if (counts[code] != 0) {
+            slot[code] = static_cast<int32_t>(buckets.size());
+            buckets.push_back(Bucket{code, {}});
+            buckets.back().candidates.reserve(counts[code]);
+            counts[code] = 0;
+        }
+        buckets[slot[code]].candidates.push_back(a);
+    }
+    std::sort(buckets.begin(), buckets.end(), [](const Bucket& a, const Bucket& b) {
+        return a.code < b.code;
+    });
+    return buckets;
+}
+
+// Guesses that split the candidates most evenly first
+// Guesses that leave every candidate in one bucket are dropped
+std::vector<uint32_t> OptimalBuilder::order_guesses(const Candidates& c) {
+    thread_local std::vector<uint16_t> counts(Response::combinations);
+    std::vector<std::pair<uint64_t, uint32_t>> keyed;
+    for (uint32_t g = 0; g < config.guesses.size(); g++) {
+        for (auto a : c) {
+            counts[score(g, a)]++;
+        }
+        uint64_t sum_squares = 0;
+        bool progress = true;
+        for (auto a : c) {
+            uint16_t code = score(g, a);
+            uint64_t n = counts[code];
+            if (n == 0) {
+                continue;
+            }
+            if (n == c.size() && code != all_green) {
+                progress = false;
+            }
+            // The all-green bucket is finished, so it doesn't count
+            if (code != all_green) {
+                sum_squares += n * n;
+            }
+            // Only count each bucket once
+            counts[code] = 0;
+        }
+        if (progress) {
+            keyed.emplace_back(sum_squares, g);
+        }
+    }
+    std::sort(keyed.begin(), keyed.end());
+    if (config.max_guesses != 0 && keyed.size() > config.max_guesses) {
+        keyed.resize(config.max_guesses);
+    }
+    std::vector<uint32_t> order;
+    order.reserve(keyed.size());
+    for (auto [key, g] : keyed) {
+        order.push_back(g);
+    }
+    return order;
+}
+
+Result OptimalBuilder::evaluate(const Candidates& c, unsigned depth, uint32_t guess, uint32_t limit) {
+    auto buckets = partition(c, guess);
+    // Larger buckets first, so the bound tightens early
+    std::stable_sort(buckets.begin(), buckets.end(), [](const Bucket& a, const Bucket& b) {
+        return a.candidates.size() > b.candidates.size();
+    });
+
+    uint32_t total = static_cast<uint32_t>(c.size());
+    uint32_t rest = 0;
+    for (const auto& b : buckets) {
+        if (b.code != all_green) {
+            rest += lower_bound(b.candidates.size());
+        }
+    }
+    if (total + rest > limit) {
+        return Result{total + rest, 0, false, guess};
+    }
+
+    uint8_t worst = 1;
+    for (const auto& b : buckets) {
+        if (b.code == all_green) {
+            continue;
+        }
+        rest -= lower_bound(b.candidates.size());
+        auto r = solve(b.candidates, depth - 1, limit - total - rest);
+        if (!r.exact) {
+            return Result{total + r.total + rest, 0, false, guess};
+        }
+        total += r.total;
+        if (total + rest > limit) {
+            // The child was exact but used more than its share
+            return Result{total + rest, 0, false, guess};
+        }
+        worst = std::max<uint8_t>(worst, r.worst + 1);
+    }
+    return Result{total, worst, true, guess};
+}
+
+Result OptimalBuilder::solve(const Candidates& c, unsigned depth, uint32_t limit) {
+    size_t n = c.size();
+    assert(n != 0);
+    if (depth == 0) {
+        // Out of guesses, even for a single candidate
+        return Result{infinite, 0, false, 0};
+    }
+    if (n == 1) {
+        return Result{1, 1, true, answer_guess[c[0]]};
+    }
+    if (depth <= 1) {
+        // Can't tell the candidates apart in time
+        return Result{infinite, 0, false, 0};
+    }
+    if (n == 2) {
+        return Result{3, 2, true, answer_guess[c[0]]};
+    }
+    if (lower_bound(n) > limit) {
+        return Result{lower_bound(n), 0, false, 0};
+    }
+
+    Key key{depth, c};
+    if (auto r = memo.find(key); r.has_value()) {
+        if (r->exact && r->total > limit) {
+            // Still a valid bound, but over the caller's limit
+            return Result{r->total, 0, false, r->guess};
+        }
+        if (r->exact || r->total > limit) {
+            return *r;
+        }
+    }
+
+    Result best;
+    for (auto g : order_guesses(c)) {
+        // Equal totals are still explored to find a better worst case
+        uint32_t bound = best.exact ? best.total : limit;
+        auto r = evaluate(c, depth, g, bound);
+        if (r.exact && (!best.exact || better(r, best))) {
+            best = r;
+        }
+    }
+    if (!best.exact) {
+        // Nothing fits within the limit
+        best.total = limit >= infinite ? infinite : limit + 1;
+    }
+    memo.store(key, best);
+    return best;
+}
+
+std::optional<OptimalResult> OptimalBuilder::run() {
+    WORDLE_TRACE_SPAN("OptimalBuilder::run");
+    if (config.max_depth == 0) {
+        return std::nullopt;
+    }
+    Candidates root(config.answers.size());
+    std::iota(root.begin(), root.end(), 0);
+    auto order = order_guesses(root);
+
+    // The root's guesses are evaluated in parallel, sharing the best total
+    // as the bound. Ties go to the guess earlier in the order.
+    std::mutex best_mutex;
+    Result best;
+    size_t best_index = SIZE_MAX;
+    std::atomic<uint32_t> bound = infinite;
+    std::atomic<size_t> next = 0;
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned t = 0; t < config.threads; t++) {
+            workers.emplace_back([&] {
+                for (size_t i; (i = next++) < order.size();) {
+                    WORDLE_TRACE_SPAN("evaluate root guess");
+                    auto r = evaluate(root, config.max_depth, order[i], bound.load());
+                    if (!r.exact) {
+                        continue;
+                    }
+                    std::lock_guard lock(best_mutex);
+                    if (!best.exact || better(r, best) || (!better(best, r) && i < best_index)) {
+                        best = r;
+                        best_index = i;
+                        bound.store(best.total);
+                        std::clog << "Best so far: " << config.guesses[r.guess]
+                                  << " total " << r.total << " worst " << int(r.worst)
+                                  << " (" << i + 1 << "/" << order.size() << ")" << std::endl;
+                    }
+                }
+            });
+        }
+    }
+
+    if (!best.exact) {
+        return std::nullopt;
+    }
+    memo.store(Key{config.max_depth, root}, best);
+    return OptimalResult{build(root, best.guess), best.total, best.worst};
+}
+
+// Lays the tree out breadth-first, so each node's children are contiguous
+// and ordered by response code
+DecisionTree OptimalBuilder::build(const Candidates& root, uint32_t guess) {
+    WORDLE_TRACE_SPAN("OptimalBuilder::build");
+    DecisionTree tree;
+    struct Pending {
+        Candidates candidates;
+        unsigned depth;
+        uint32_t guess;
+    };
+    std::queue<Pending> queue;
+    queue.push(Pending{root, config.max_depth, guess});
+    while (!queue.empty()) {
+        auto p = std::move(queue.front());
+        queue.pop();
+
+        DecisionTree::NodeData node{};
+        node.guess = config.guesses[p.guess];
+        node.first_child = static_cast<uint32_t>(tree.nodes.size() + queue.size() + 1);
+        for (auto& b : partition(p.candidates, p.guess)) {
+            if (b.code == all_green) {
+                continue;
+            }
+            node.present[b.code / 64] |= uint64_t(1) << (b.code % 64);
+            auto r = solve(b.candidates, p.depth - 1, infinite);
+            assert(r.exact);
+            queue.push(Pending{std::move(b.candidates), p.depth - 1, r.guess});
+        }
+        uint16_t rank = 0;
+        for (size_t i = 0; i < node.present.size(); i++) {
+            node.rank[i] = rank;
+            rank += std::popcount(node.present[i]);
+        }
+        tree.nodes.push_back(node);
+    }
+    return tree;
+}
+
+std::optional<OptimalResult> solve_optimal(const OptimalConfig& config) {
+    OptimalBuilder builder(config);
+    return builder.run();
+}
+
+DecisionTree::Node DecisionTree::next(Node n, const Response& r) const {
+    const auto& node = nodes[n];
+    uint16_t code = r.code();
+    uint64_t word = node.present[code / 64];
+    uint64_t bit = uint64_t(1) << (code % 64);
+    if ((word & bit) == 0) {
+        return none;
+    }
+    return node.first_child + node.rank[code / 64] + std::popcount(word & (bit - 1));
+}
+
+// Format: "WDTR", version, word length, node count, then the nodes
+static constexpr std::array<char, 4> tree_magic = {'W', 'D', 'T', 'R'};
+static constexpr uint32_t tree_version = 1;
+
+std::ostream& DecisionTree::serialize(std::ostream& out) const {
+    out.write(tree_magic.data(), tree_magic.size());
+    uint32_t header[] = {tree_version, word_length, static_cast<uint32_t>(nodes.size())};
+    out.write(reinterpret_cast<const char*>(header), sizeof header);
+    for (const auto& node : nodes) {
+        node.guess.serialize(out);
+        out.write(reinterpret_cast<const char*>(&node.first_child), sizeof node.first_child);
+        out.write(reinterpret_cast<const char*>(node.present.data()), sizeof node.present);
+        out.write(reinterpret_cast<const char*>(node.rank.data()), sizeof node.rank);
+    }
+    return out;
+}
+
+DecisionTree DecisionTree::deserialize(std::istream& in) {
+    DecisionTree tree;
+    std::array<char, 4> magic;
+    uint32_t header[3];
+    in.read(magic.data(), magic.size());
+    in.read(reinterpret_cast<char*>(header), sizeof header);
+    if (!in || magic != tree_magic || header[0] != tree_version || header[1] != word_length) {
+        return tree;
+    }
+
+    // Don't trust the node count further than the input goes
+    constexpr size_t node_size = sizeof(Word::bits_t) + sizeof(uint32_t)
+        + sizeof(NodeData::present) + sizeof(NodeData::rank);
+    auto start = in.tellg();
+    in.seekg(0, std::ios_base::end);
+    auto end = in.tellg();
+    in.seekg(start);
+    if (start < 0 || end < start || uint64_t(end - start) / node_size < header[2]) {
+        return tree;
+    }
+
+    tree.nodes.resize(header[2]);
+    for (auto& node : tree.nodes) {
+        node.guess = Word::deserialize(in);
+        in.read(reinterpret_cast<char*>(&node.first_child), sizeof node.first_child);
+        in.read(reinterpret_cast<char*>(node.present.data()), sizeof node.present);
+        in.read(reinterpret_cast<char*>(node.rank.data()), sizeof node.rank);
+    }
+    if (!in) {
+        tree.nodes.clear();
+        return tree;
+    }
+
+    // Children must come after their parent (so walks end) and fit in the tree,
+    // and the ranks must agree with the masks, so next() stays in bounds
+    for (size_t i = 0; i < tree.nodes.size(); i++) {
+        const auto& node = tree.nodes[i];
+        uint64_t children = 0;
+        bool valid = true;
+        for (size_t k = 0; k < mask_words; k++) {
+            valid &= node.rank[k] == children;
+            children += std::popcount(node.present[k]);
+        }
+        if (children != 0) {
+            valid &= node.first_child > i && node.first_child + children <= tree.nodes.size();
+        }
+        if (!valid) {
+            tree.nodes.clear();
+            return tree;
+        }
+    }
+    return tree;
+}
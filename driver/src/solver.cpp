@@ -1,55 +1,218 @@
 #include <algorithm>
+#include <array>
+#include <numeric>
 #include <queue>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <wordle.hpp>
+#include <trace.hpp>
 #include <resources.hpp>
+#include <arena.hpp>
+#include <solver.hpp>
 
-using namespace wordle;
+using Word = wordle::Word<word_length>;
+using Response = wordle::Response<word_length>;
+using State = wordle::State<word_length>;
+using StateId = StateArena::Id;
 
-struct hash_pair {
-    size_t operator()(const std::pair<State, Word>& p) const noexcept {
-        auto h1 = std::hash<State>{}(p.first);
-        auto h2 = std::hash<Word>{}(p.second);
-        return h1 ^ h2;
+// Server decisions are keyed by (state id, guess index)
+using ServerKey = uint64_t;
+
+static ServerKey server_key(StateId s, uint32_t word_idx) {
+    return (uint64_t(s) << 32) | word_idx;
+}
+
+static StateId key_state(ServerKey p) {
+    return static_cast<StateId>(p >> 32);
+}
+
+static uint32_t key_word(ServerKey p) {
+    return static_cast<uint32_t>(p);
+}
+
+// The words the solver may guess, and the words that may be the secret
+// Answers are a subset of the guesses
+static const struct {
+    std::span<const Word> guesses = wordlist;
+    std::span<const Word> answers = answerlist;
+} config;
+static auto arena = std::make_unique<StateArena>(config.guesses);
+static std::unordered_map<StateId, int> player_cache;
+static std::unordered_map<ServerKey, int> server_cache;
+
+// Cache files start with a header recording the dictionary they were
+// computed for, followed by the guess and answer lists themselves,
+// so that a later run can tell which words changed.
+//
+// The entries store full states and words, since ids are only
+// meaningful to the arena that assigned them
+static constexpr std::array<char, 4> cache_magic = {'W', 'S', 'L', 'V'};
+static constexpr uint32_t cache_version = 2;
+
+// FNV-1a over the word length and both word lists
+static uint64_t fingerprint(std::span<const Word> guesses, std::span<const Word> answers) {
+    uint64_t hash = 0xcbf29ce484222325;
+    auto add = [&hash](uint64_t byte) {
+        hash = (hash ^ byte) * 0x100000001b3;
+    };
+    add(word_length);
+    for (auto list : {guesses, answers}) {
+        for (size_t n = list.size(), i = 0; i < sizeof n; i++) {
+            add((n >> (8 * i)) & 0xff);
+        }
+        for (const auto& w : list) {
+            for (size_t i = 0; i < w.size(); i++) {
+                add(w[i]);
+            }
+        }
     }
-};
+    return hash;
+}
 
-static std::unordered_map<State, int> player_cache;
-static std::unordered_map<std::pair<State, Word>, int, hash_pair> server_cache;
+static void write_words(std::ostream& out, std::span<const Word> words) {
+    size_t size = words.size();
+    out.write(reinterpret_cast<char*>(&size), sizeof size);
+    for (const auto& w : words) {
+        w.serialize(out);
+    }
+}
+
+static std::vector<Word> read_words(std::istream& in) {
+    size_t size = 0;
+    in.read(reinterpret_cast<char*>(&size), sizeof size);
+    std::vector<Word> words;
+    for (size_t i = 0; i < size && in; i++) {
+        words.push_back(Word::deserialize(in));
+    }
+    return words;
+}
 
 void save_caches(std::ostream& out) {
+    WORDLE_TRACE_SPAN("save_caches");
+    uint32_t version = cache_version;
+    uint32_t length = word_length;
+    uint64_t hash = fingerprint(config.guesses, config.answers);
+    out.write(cache_magic.data(), cache_magic.size());
+    out.write(reinterpret_cast<char*>(&version), sizeof version);
+    out.write(reinterpret_cast<char*>(&length), sizeof length);
+    out.write(reinterpret_cast<char*>(&hash), sizeof hash);
+    write_words(out, config.guesses);
+    write_words(out, config.answers);
+
     size_t size = player_cache.size();
     out.write(reinterpret_cast<char*>(&size), sizeof size);
-    for (auto [state, rank] : player_cache) {
-        state.serialize(out);
+    for (auto [id, rank] : player_cache) {
+        arena->get(id).serialize(out);
         out.write(reinterpret_cast<char*>(&rank), sizeof rank);
     }
 
     size = server_cache.size();
     out.write(reinterpret_cast<char*>(&size), sizeof size);
     for (auto [p, rank] : server_cache) {
-        auto [state, word] = p;
-        state.serialize(out);
-        word.serialize(out);
+        arena->get(key_state(p)).serialize(out);
+        config.guesses[key_word(p)].serialize(out);
         out.write(reinterpret_cast<char*>(&rank), sizeof rank);
     }
 }
 
-void load_caches(std::istream& in) {
+// Words in exactly one of the lists
+static std::vector<Word> difference(std::span<const Word> a, std::span<const Word> b) {
+    std::unordered_set<Word> in_a(a.begin(), a.end());
+    std::unordered_set<Word> in_b(b.begin(), b.end());
+    std::vector<Word> changed;
+    for (const auto& w : a) {
+        if (!in_b.contains(w)) {
+            changed.push_back(w);
+        }
+    }
+    for (const auto& w : b) {
+        if (!in_a.contains(w)) {
+            changed.push_back(w);
+        }
+    }
+    return changed;
+}
+
+void load_caches(std::istream& in, bool incremental) {
+    WORDLE_TRACE_SPAN("load_caches");
+    std::array<char, cache_magic.size()> magic{};
+    uint32_t version = 0;
+    uint32_t length = 0;
+    uint64_t hash = 0;
+    in.read(magic.data(), magic.size());
+    in.read(reinterpret_cast<char*>(&version), sizeof version);
+    in.read(reinterpret_cast<char*>(&length), sizeof length);
+    in.read(reinterpret_cast<char*>(&hash), sizeof hash);
+    if (!in || magic != cache_magic || version != cache_version) {
+        throw new std::runtime_error("Not a solver cache file, or from an older version");
+    }
+    if (length != word_length) {
+        throw new std::runtime_error("Solver cache is for a different word length");
+    }
+    auto old_guesses = read_words(in);
+    auto old_answers = read_words(in);
+
+    // Every rank depends only on the answers that match its state, since
+    // later states are always more constrained. An answer change therefore
+    // only invalidates the entries whose state matches a changed answer.
+    //
+    // Every decision with more than one candidate chooses among all of the
+    // guesses, so a guess change invalidates everything except the decisions
+    // that don't look at the guess list: players with at most one candidate
+    // and servers that must accept the guess (rank 0).
+    std::vector<Word> answers_changed;
+    bool guesses_changed = false;
+    if (hash != fingerprint(config.guesses, config.answers)) {
+        if (!incremental) {
+            throw new std::runtime_error("Solver cache was computed for a different dictionary");
+        }
+        answers_changed = difference(old_answers, config.answers);
+        auto guesses_delta = difference(old_guesses, config.guesses);
+        guesses_changed = !guesses_delta.empty();
+        std::clog << "Dictionary changed: " << guesses_delta.size() << " guesses and "
+                  << answers_changed.size() << " answers added or removed\n";
+    }
+    auto affected = [&](const State& state) {
+        return std::any_of(answers_changed.begin(), answers_changed.end(),
+                           [&](const Word& w) { return state.matches(w); });
+    };
+    auto trivial = [&](const State& state) {
+        size_t matching = 0;
+        for (const auto& w : config.answers) {
+            if (state.matches(w) && ++matching > 1) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::unordered_map<Word, uint32_t> word_index;
+    for (uint32_t i = 0; i < config.guesses.size(); i++) {
+        word_index.insert(std::pair(config.guesses[i], i));
+    }
+
     size_t size;
+    size_t dropped = 0;
     in.read(reinterpret_cast<char*>(&size), sizeof size);
     for (size_t i = 0; i < size; i++) {
         auto state = State::deserialize(in);
         int rank;
         in.read(reinterpret_cast<char*>(&rank), sizeof rank);
-        player_cache.insert(std::pair(state, rank));
+        if (affected(state) || (guesses_changed && !trivial(state))) {
+            dropped++;
+            continue;
+        }
+        player_cache.insert(std::pair(arena->intern(state), rank));
     }
 
     in.read(reinterpret_cast<char*>(&size), sizeof size);
@@ -58,159 +221,295 @@ void load_caches(std::istream& in) {
         auto word = Word::deserialize(in);
         int rank;
         in.read(reinterpret_cast<char*>(&rank), sizeof rank);
-        server_cache.insert(std::pair(std::pair(state, word), rank));
+        auto it = word_index.find(word);
+        if (it == word_index.end() || affected(state) || (guesses_changed && rank != 0)) {
+            dropped++;
+            continue;
+        }
+        server_cache.insert(std::pair(server_key(arena->intern(state), (*it).second), rank));
+    }
+    if (dropped != 0) {
+        std::clog << "Invalidated " << dropped << " cache entries\n";
     }
 }
 
-static int player_rank(const State& s);
-static int server_rank(const State& s, const Word& w);
+// Dependency graph
+//
+// Every player decision (State) depends on one server decision per guess,
+// and every server decision (State, Word) depends on one player decision
+// per valid response. Instead of re-running a decision until all of its
+// children happen to be cached, each pending node counts its unresolved
+// children and remembers the parents waiting on it. A node is resolved
+// exactly once, when its count reaches zero, so decisions complete in
+// reverse-topological order.
+//
+// Ranks: the player minimizes and the server maximizes. -1 marks a decision
+// with no valid options, and is ignored by the parent.
+//
+// Only config.answers can be the secret. Each pending player decision keeps
+// its candidate answers, which its server decisions partition by response:
+// a response is valid only if some candidate gives it, and a decision ends
+// once the candidates are narrowed down to the guess itself.
+//
+// State::update only ever adds information, so a child is either equal to its
+// parent or strictly more constrained. The graph is therefore acyclic once
+// responses that leave the state unchanged are handled (see server_expand).
 
-static std::queue<State> player_work_queue;
-static std::queue<std::pair<State, Word>> server_work_queue;
-
-// Returns the rank of the best word (minimizes rank)
-// Returns -1 if there aren't any valid words
-// Returns -2 if we need to wait on a server decision (server_work_queue updated)
-static int player_decide(const State& s) {
+struct PlayerNode {
+    int pending = 0;
     int best_rank = std::numeric_limits<int>::max();
+    std::vector<ServerKey> parents;
+    // Indices into config.answers that match the state
+    std::vector<uint32_t> candidates;
+};
 
-    bool ok = true;
-    for (auto w : wordlist) {
-        auto it = server_cache.find(std::pair(s, w));
-        if (it == server_cache.end()) {
-            ok = false;
-            server_work_queue.push(std::pair(s, w));
-        } else if (ok) {
-            int rank = (*it).second;
-            if (rank != -1 && rank < best_rank) {
-                best_rank = rank;
-            }
+struct ServerNode {
+    int pending = 0;
+    int best_rank = std::numeric_limits<int>::min();
+    std::vector<StateId> parents;
+};
+
+static std::unordered_map<StateId, PlayerNode> player_pending;
+static std::unordered_map<ServerKey, ServerNode> server_pending;
+
+// Nodes whose children have not been enumerated yet
+static std::queue<StateId> player_work_queue;
+static std::queue<ServerKey> server_work_queue;
+
+// Nodes whose children are all resolved
+static std::queue<StateId> player_ready_queue;
+static std::queue<ServerKey> server_ready_queue;
+
+static void player_fold(PlayerNode& node, int server_rank) {
+    if (server_rank != -1 && server_rank < node.best_rank) {
+        node.best_rank = server_rank;
+    }
+}
+
+static void server_fold(ServerNode& node, int player_rank) {
+    if (player_rank != -1 && player_rank > node.best_rank) {
+        node.best_rank = player_rank;
+    }
+}
+
+// Records the final rank and notifies every waiting parent
+static void player_resolve(StateId s, int rank) {
+    auto it = player_pending.find(s);
+    assert(it != player_pending.end());
+    auto parents = std::move((*it).second.parents);
+    player_pending.erase(it);
+    player_cache.insert(std::pair(s, rank));
+
+    for (auto p : parents) {
+        auto parent = server_pending.find(p);
+        assert(parent != server_pending.end());
+        auto& node = (*parent).second;
+        server_fold(node, rank);
+        if (--node.pending == 0) {
+            server_ready_queue.push(p);
+        }
+    }
+}
+
+static void server_resolve(ServerKey p, int rank) {
+    auto it = server_pending.find(p);
+    assert(it != server_pending.end());
+    auto parents = std::move((*it).second.parents);
+    server_pending.erase(it);
+    server_cache.insert(std::pair(p, rank));
+
+    for (auto s : parents) {
+        auto parent = player_pending.find(s);
+        assert(parent != player_pending.end());
+        auto& node = (*parent).second;
+        player_fold(node, rank);
+        if (--node.pending == 0) {
+            player_ready_queue.push(s);
         }
     }
+}
 
-    if (!ok) {
-        return -2;
-    } else if (best_rank == std::numeric_limits<int>::max()) {
+// Returns the rank of the best word (minimizes rank)
+// Returns -1 if there aren't any valid words
+static int player_finish(const PlayerNode& node) {
+    if (node.best_rank == std::numeric_limits<int>::max()) {
         return -1;
-    } else {
-        return best_rank;
     }
+    return node.best_rank;
 }
 
 // Returns the rank of the best response (maximizes rank)
 // Returns -1 if there aren't any valid responses
-// Returns -2 if we need to wait on a player decision (player_work_queue updated)
-static int server_decide(const State& s, const Word& w) {
-    // Check if the final word is already decided
-    auto final = s.final();
-    if (final.has_value() && final.value() == w) {
-        return 0;
+static int server_finish(const ServerNode& node) {
+    if (node.best_rank == std::numeric_limits<int>::min()) {
+        return -1;
+    }
+    return node.best_rank + 1;
+}
+
+// The subset of `candidates` that can still be the secret in state `s`
+static std::vector<uint32_t> filter_candidates(StateId s, const std::vector<uint32_t>& candidates) {
+    const auto& state = arena->get(s);
+    std::vector<uint32_t> matching;
+    for (auto a : candidates) {
+        if (state.matches(config.answers[a])) {
+            matching.push_back(a);
+        }
     }
+    return matching;
+}
 
-    int best_rank = std::numeric_limits<int>::min();
+// Registers `child` as a dependency of `parent`, creating it if needed
+// New children take the parent's candidates that still match
+// Returns false if the child was already resolved (and folds its rank)
+static bool player_depend(StateId child, ServerKey parent, ServerNode& node,
+                          const std::vector<uint32_t>& parent_candidates) {
+    if (auto it = player_cache.find(child); it != player_cache.end()) {
+        server_fold(node, (*it).second);
+        return false;
+    }
+    auto [it, inserted] = player_pending.try_emplace(child);
+    (*it).second.parents.push_back(parent);
+    if (inserted) {
+        (*it).second.candidates = filter_candidates(child, parent_candidates);
+        player_work_queue.push(child);
+    }
+    node.pending++;
+    return true;
+}
+
+static bool server_depend(ServerKey child, StateId parent, PlayerNode& node) {
+    if (auto it = server_cache.find(child); it != server_cache.end()) {
+        player_fold(node, (*it).second);
+        return false;
+    }
+    auto [it, inserted] = server_pending.try_emplace(child);
+    (*it).second.parents.push_back(parent);
+    if (inserted) {
+        server_work_queue.push(child);
+    }
+    node.pending++;
+    return true;
+}
+
+// Enumerates the server decisions a player decision depends on
+static void player_expand(StateId s) {
+    WORDLE_TRACE_LEAF_SPAN("player_expand");
+    auto& node = player_pending.at(s);
+    if (node.candidates.empty()) {
+        // Unreachable: no secret is consistent with the state
+        player_resolve(s, -1);
+        return;
+    }
+    if (node.candidates.size() == 1) {
+        // Guessing the only candidate ends the game
+        player_resolve(s, 0);
+        return;
+    }
+    for (uint32_t w = 0; w < config.guesses.size(); w++) {
+        server_depend(server_key(s, w), s, node);
+    }
+    if (node.pending == 0) {
+        player_ready_queue.push(s);
+    }
+}
+
+// Enumerates the player decisions a server decision depends on
+static void server_expand(ServerKey p) {
+    WORDLE_TRACE_LEAF_SPAN("server_expand");
+    StateId s = key_state(p);
+    uint32_t w = key_word(p);
 
-    bool ok = true;
-    Response r{};
-    do {
-        State state = s;
-        if (!state.update(w, r))
+    const auto& candidates = player_pending.at(s).candidates;
+
+    // Only responses given by some candidate are valid
+    constexpr uint16_t all_green = Response::combinations - 1;
+    std::array<bool, Response::combinations> valid{};
+    for (auto a : candidates) {
+        valid[Response::score(config.guesses[w], config.answers[a]).code()] = true;
+    }
+
+    // The guess is the only candidate left, so the server must accept it.
+    // Otherwise accepting it is never the server's best response.
+    if (std::count(valid.begin(), valid.end(), true) == 1 && valid[all_green]) {
+        server_resolve(p, 0);
+        return;
+    }
+
+    std::vector<StateId> children;
+    for (uint16_t code = 0; code < all_green; code++) {
+        if (!valid[code])
             continue;
-        auto it = player_cache.find(s);
-        if (it == player_cache.end()) {
-            ok = false;
-            player_work_queue.push(s);
-        } else if (ok) {
-            int rank = (*it).second;
-            if (rank != -1 && rank > best_rank) {
-                best_rank = rank;
-            }
+        StateId state = arena->transition(s, w, Response::from_code(code));
+        if (state == StateArena::invalid)
+            continue;
+        if (state == s) {
+            // The server can repeat this response forever, so the guess
+            // never makes progress. The player should never pick it.
+            server_resolve(p, -1);
+            return;
         }
-    } while (r.next_combination());
+        children.push_back(state);
+    }
 
-    if (!ok) {
-        return -2;
-    } else if (best_rank == std::numeric_limits<int>::min()) {
-        return -1;
-    } else {
-        return best_rank + 1;
+    auto& node = server_pending.at(p);
+    for (auto state : children) {
+        player_depend(state, p, node, candidates);
+    }
+    if (node.pending == 0) {
+        server_ready_queue.push(p);
     }
 }
 
 void run() {
-    int rank = player_decide(State{});
-    std::clog << "Returned " << rank << "\n";
-    if (rank != -2) {
-        return;
+    const StateId root = arena->intern(State{});
+    if (!player_cache.contains(root)) {
+        std::vector<uint32_t> answers(config.answers.size());
+        std::iota(answers.begin(), answers.end(), 0);
+        player_pending[root].candidates = filter_candidates(root, answers);
+        player_work_queue.push(root);
     }
-    while (!server_work_queue.empty() || !player_work_queue.empty()) {
+
+    while (!server_work_queue.empty() || !player_work_queue.empty()
+            || !server_ready_queue.empty() || !player_ready_queue.empty()) {
         std::clog << "Server Done: " << server_cache.size() << "\n";
         std::clog << "Player Done: " << player_cache.size() << "\n";
         std::clog << "Server: " << server_work_queue.size() << "\n";
         std::clog << "Player: " << player_work_queue.size() << "\n";
-        // Advance server queue as much as possble
+        std::clog << "Waiting: " << server_pending.size() + player_pending.size() << "\n";
+        std::clog << "States: " << arena->size() << "\n";
+
+        // Expand the current frontier
         {
-            std::unordered_set<std::pair<State, Word>, hash_pair> still_waiting;
+            WORDLE_TRACE_SPAN("drain server_work_queue");
             for (; !server_work_queue.empty(); server_work_queue.pop()) {
-                auto p = server_work_queue.front();
-                if (!server_cache.contains(p) && !still_waiting.contains(p)) {
-                    int ret = server_decide(p.first, p.second);
-                    if (ret != -2) {
-                        server_cache.insert(std::pair(p, ret));
-                    } else {
-                        still_waiting.insert(p);
-                    }
-                }
-            }
-
-            for (auto p : still_waiting) {
-                server_work_queue.push(p);
+                server_expand(server_work_queue.front());
             }
         }
-
-        // Advance player queue as much as possible
         {
-            std::unordered_set<State> still_waiting;
+            WORDLE_TRACE_SPAN("drain player_work_queue");
             for (; !player_work_queue.empty(); player_work_queue.pop()) {
-                auto s = player_work_queue.front();
-                if (!player_cache.contains(s) && !still_waiting.contains(s)) {
-                    int ret = player_decide(s);
-                    if (ret != -2) {
-                        player_cache.insert(std::pair(s, ret));
-                    } else {
-                        still_waiting.insert(s);
-                    }
-                }
+                player_expand(player_work_queue.front());
             }
+        }
 
-            for (auto p : still_waiting) {
-                player_work_queue.push(p);
+        // Resolve everything whose dependencies are met
+        WORDLE_TRACE_SPAN("drain ready queues");
+        while (!server_ready_queue.empty() || !player_ready_queue.empty()) {
+            for (; !server_ready_queue.empty(); server_ready_queue.pop()) {
+                auto p = server_ready_queue.front();
+                server_resolve(p, server_finish(server_pending.at(p)));
             }
-        }       
+            for (; !player_ready_queue.empty(); player_ready_queue.pop()) {
+                auto s = player_ready_queue.front();
+                player_resolve(s, player_finish(player_pending.at(s)));
+            }
+        }
 
         // Save the work
         std::ofstream out("log.bin", std::ios_base::binary | std::ios_base::trunc);
         save_caches(out);
     }
     std::clog << "Queues are empty\n";
+    std::clog << "Returned " << player_cache.at(root) << "\n";
 }
-
-// Memoization
-
-/* static int player_rank(const State& s) { */
-/*     auto it = player_cache.find(s); */
-/*     if (it == player_cache.end()) { */
-/*         it = player_cache.insert(std::pair(s, player_decide(s))).first; */
-/*         assert(it != player_cache.end()); */
-/*     } */
-/*     return (*it).second; */
-/* } */
-
-/* static int server_rank(const State& s, const Word& w) { */
-/*     auto p = std::pair(s, w); */
-/*     auto it = server_cache.find(p); */
-/*     if (it == server_cache.end()) { */
-/*         it = server_cache.insert(std::pair(p, server_decide(s, w))).first; */
-/*         assert(it != server_cache.end()); */
-/*     } */
-/*     return (*it).second; */
-/* } */
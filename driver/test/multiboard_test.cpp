@@ -0,0 +1,96 @@
+// Checks that MultiAbsurd boards end on distinct secrets, and that every
+// response a board gave is the true score against the secret it ended on.
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <set>
+#include <vector>
+#include <wordle.hpp>
+#include <resources.hpp>
+#include <multiboard.hpp>
+
+using Word = MultiAbsurd::Word;
+using Response = MultiAbsurd::Response;
+
+namespace {
+int failures = 0;
+
+void check(bool ok, const char *what) {
+  if (!ok && failures++ < 10) {
+    std::cerr << "check failed: " << what << std::endl;
+  }
+}
+
+Word repeated(char c) {
+  std::array<char, word_length> ascii;
+  ascii.fill(c);
+  return Word(ascii.data());
+}
+
+// Plays each board's example until every board is solved
+void play(const std::vector<Word>& answers, size_t boards, unsigned threads) {
+  MultiAbsurd game(boards, answers, threads);
+  std::vector<Word> guesses;
+  std::vector<std::vector<std::optional<Response>>> history;
+  while (!game.all_solved() && guesses.size() < 2 * answers.size()) {
+    size_t b = 0;
+    while (game.solved(b)) {
+      b++;
+    }
+    guesses.push_back(game.example(b));
+    history.push_back(game.respond(guesses.back()));
+  }
+  check(game.all_solved(), "boards weren't solved");
+
+  std::set<Word::bits_t> secrets;
+  for (size_t b = 0; b < boards; b++) {
+    auto secret = game.example(b);
+    secrets.insert(secret.bits());
+    for (size_t i = 0; i < guesses.size(); i++) {
+      if (history[i][b].has_value()) {
+        check(*history[i][b] == Response::score(guesses[i], secret), "response isn't the secret's score");
+      }
+    }
+  }
+  check(secrets.size() == boards, "boards share a secret");
+}
+}
+
+int main() {
+  // Both boards would rather answer all gray, but only one can
+  {
+    std::vector<Word> answers = {repeated('A'), repeated('B')};
+    MultiAbsurd game(2, answers, 1);
+    auto r = game.respond(answers[0]);
+    check(r[0].has_value() && r[1].has_value() && *r[0] != *r[1], "boards gave the same response");
+    check(game.solved(0) != game.solved(1), "exactly one board should be solved");
+  }
+
+  // Random answer lists over a few letters
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int> letter(0, 3);
+  for (int round = 0; round < 50; round++) {
+    std::set<Word::bits_t> seen;
+    std::vector<Word> answers;
+    while (answers.size() < 30) {
+      std::array<char, word_length> ascii;
+      for (auto& c : ascii) {
+        c = char('A' + letter(rng));
+      }
+      Word w(ascii.data());
+      if (seen.insert(w.bits()).second) {
+        answers.push_back(w);
+      }
+    }
+    play(answers, 1 + round % 8, 1 + round % 3);
+  }
+
+  if (failures != 0) {
+    std::cerr << failures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,69 @@
+// trace.hpp
+// Optional timeline tracing for profiling hot paths.
+// Spans are recorded into per-thread buffers without locking,
+// and written out as Chrome/Perfetto trace-event JSON.
+//
+// Tracing is compiled in only when WORDLE_TRACE is defined
+// (configure with -DWORDLE_TRACE=ON). Otherwise WORDLE_TRACE_SPAN
+// expands to nothing and flush() does nothing.
+//
+// WORDLE_TRACE_LEAF_SPAN marks spans that run millions of times
+// (State::update, State::matches, ...). They are only recorded when
+// WORDLE_TRACE_LEAF is also defined (-DWORDLE_TRACE_LEAF=ON), and go to
+// a separate buffer, so they can never crowd out the coarse spans.
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#define WORDLE_TRACE_CONCAT_(a, b) a##b
+#define WORDLE_TRACE_CONCAT(a, b) WORDLE_TRACE_CONCAT_(a, b)
+
+namespace wordle::trace {
+
+#ifdef WORDLE_TRACE
+
+enum class Level : uint8_t {
+  COARSE,
+  LEAF
+};
+
+// Records the time between construction and destruction
+// `name` must outlive the trace (use a string literal)
+class Span {
+public:
+  explicit Span(const char *name, Level level = Level::COARSE) noexcept;
+  ~Span();
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+private:
+  const char *name;
+  uint64_t start;
+  Level level;
+};
+
+// Writes every span recorded so far, from all threads
+// Spans still being recorded concurrently may or may not be included
+void flush(std::ostream& out);
+
+#define WORDLE_TRACE_SPAN(name) \
+  ::wordle::trace::Span WORDLE_TRACE_CONCAT(wordle_trace_span_, __LINE__){name}
+
+#ifdef WORDLE_TRACE_LEAF
+#define WORDLE_TRACE_LEAF_SPAN(name) \
+  ::wordle::trace::Span WORDLE_TRACE_CONCAT(wordle_trace_span_, __LINE__){name, ::wordle::trace::Level::LEAF}
+#else
+#define WORDLE_TRACE_LEAF_SPAN(name) ((void)0)
+#endif
+
+#else
+
+inline void flush(std::ostream&) {}
+
+#define WORDLE_TRACE_SPAN(name) ((void)0)
+#define WORDLE_TRACE_LEAF_SPAN(name) ((void)0)
+
+#endif
+
+}
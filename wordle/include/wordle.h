@@ -0,0 +1,92 @@
+/* wordle.h
+ * Stable C interface to the wordle library, built as the wordle_c
+ * shared library. Every function works on batches in caller-owned
+ * buffers: nothing is allocated, and no C++ exception escapes.
+ *
+ * Words are passed as packed ASCII: `count * length` bytes of 'A'-'Z'
+ * with no separators or terminators.
+ *
+ * Responses are passed as base-3 codes with the first letter most
+ * significant, where gray = 0, yellow = 1 and green = 2.
+ * For example "_YG" is 0*9 + 1*3 + 2 = 5, and all green is 3^length - 1.
+ */
+
+#ifndef WORDLE_H
+#define WORDLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(WORDLE_C_BUILD)
+#    define WORDLE_C_API __declspec(dllexport)
+#  else
+#    define WORDLE_C_API __declspec(dllimport)
+#  endif
+#else
+#  define WORDLE_C_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a signature or the layout of wordle_state changes */
+#define WORDLE_ABI_VERSION 1
+
+typedef enum wordle_status {
+  WORDLE_OK = 0,
+  /* A required pointer is null, a state was made for another length,
+   * a response code is out of range, or a buffer size overflows size_t */
+  WORDLE_INVALID_ARGUMENT = 1,
+  /* A word contains a character outside 'A'-'Z' */
+  WORDLE_INVALID_WORD = 2,
+  /* The word length is outside 4-7 */
+  WORDLE_UNSUPPORTED_LENGTH = 3,
+  WORDLE_INTERNAL_ERROR = 4
+} wordle_status;
+
+/* Game state for any supported length, allocated by the caller.
+ * Initialize with wordle_state_init before use; may be copied with memcpy. */
+typedef struct wordle_state {
+  uint64_t opaque[9];
+} wordle_state;
+
+WORDLE_C_API uint32_t wordle_abi_version(void);
+
+/* Resets `count` states to the start of a game */
+WORDLE_C_API wordle_status wordle_state_init(
+  size_t length, wordle_state *states, size_t count);
+
+/* Scores every guess against every answer
+ * codes[g * n_answers + a] is the response to guesses[g] when the secret is answers[a]
+ * On error the contents of codes are unspecified */
+WORDLE_C_API wordle_status wordle_score(
+  size_t length,
+  const char *guesses, size_t n_guesses,
+  const char *answers, size_t n_answers,
+  uint16_t *codes);
+
+/* Tests which words can still be the secret in `state`
+ * matches[i] is set to 1 or 0 for each word
+ * If n_matches is not null, it receives the number of matching words
+ * On error the contents of matches are unspecified */
+WORDLE_C_API wordle_status wordle_filter(
+  size_t length, const wordle_state *state,
+  const char *words, size_t n_words,
+  uint8_t *matches, size_t *n_matches);
+
+/* Applies guesses[i] with response codes[i] to states[i], for each i < count
+ * ok[i] is set to 0 if the pair is nonsensical, in which case
+ * states[i] is left unchanged; ok may be null
+ * The whole batch is validated first: on error no state is changed */
+WORDLE_C_API wordle_status wordle_update(
+  size_t length, wordle_state *states,
+  const char *guesses, const uint16_t *codes, size_t count,
+  uint8_t *ok);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,34 +1,68 @@
 // wordle.hpp
 // This file defines classes for working with Wordle.
-// Some are simply wrappers around std::array.
-// This is to add additional methods, and to override
-// operator<< for printing.
+// Words and states are packed into integers so that comparing,
+// hashing and matching are a handful of word-wide bit operations.
+// Responses are simply wrappers around std::array.
+//
+// Every class is templated on the word length N.
+// The definitions live in wordle.cpp and are explicitly
+// instantiated for the supported lengths (4 through 7),
+// so each length gets its own fully unrolled kernels.
 
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <optional>
+#include <type_traits>
 
 namespace wordle {
 
-// 5-letter words
-// Stored with A->0, Z->26 instead of ASCII
-// Invalid/Underscore characters are stored as 0xff
-class Word : public std::array<uint8_t, 5> {
+// Smallest and largest supported word lengths
+inline constexpr size_t min_length = 4;
+inline constexpr size_t max_length = 7;
+
+template<size_t N>
+concept SupportedLength = min_length <= N && N <= max_length;
+
+static_assert(max_length < 8, "State stores letter counts in 3 bits");
+
+// N-letter words
+// Packed as 5 bits per letter, with A->0, Z->25 in the lowest bits first
+// Invalid/Underscore characters are stored as `blank`
+template<size_t N>
+class Word {
+  static_assert(SupportedLength<N>, "Unsupported word length");
 public:
+  using bits_t = std::conditional_t<5 * N <= 32, uint32_t, uint64_t>;
+  static constexpr uint8_t blank = 31;
+
   // Construct a word with all underscores
   Word();
   // Construct a word from an ASCII-encoded string
-  // Throws a runtime error if any char at index 0-4 isn't A-Z
+  // Throws a runtime error if any char at index 0-(N-1) isn't A-Z
   Word(const char *word);
 
+  static constexpr size_t size() { return N; }
+  uint8_t operator[](size_t i) const { return (letters >> (5 * i)) & 0x1f; }
+  void set(size_t i, uint8_t c);
+
+  // The packed letters
+  bits_t bits() const { return letters; }
+
+  bool operator==(const Word& w) const { return letters == w.letters; }
+  bool operator!=(const Word& w) const { return letters != w.letters; }
+
   std::ostream& serialize(std::ostream& out) const;
   static Word deserialize(std::istream& in);
+private:
+  bits_t letters;
 };
 
-std::ostream& operator<<(std::ostream& out, const Word& w);
+template<size_t N>
+std::ostream& operator<<(std::ostream& out, const Word<N>& w);
 
 // The response color
 enum class Color : uint8_t {
@@ -40,66 +74,119 @@ enum class Color : uint8_t {
 std::ostream& operator<<(std::ostream& out, Color c);
 
 // Response sent back from the computer
-class Response : public std::array<Color, 5> {
+template<size_t N>
+class Response : public std::array<Color, N> {
+  static_assert(SupportedLength<N>, "Unsupported word length");
 public:
+  // Number of distinct responses (3^N)
+  static constexpr size_t combinations = [] {
+    size_t n = 1;
+    for (size_t i = 0; i < N; i++) {
+      n *= 3;
+    }
+    return n;
+  }();
+
   Response();
+  // The response given to `guess` when the secret is `secret`
+  static Response score(const Word<N>& guess, const Word<N>& secret);
   // Produces the next combination. Returns false if there is no next combination.
   bool next_combination();
+  // Base-3 index of the response, in next_combination() order (0 to combinations - 1)
+  uint16_t code() const;
+  static Response from_code(uint16_t code);
   // Prints the word with ANSI colors based on the response
-  std::ostream& write_ansi(std::ostream &out, const Word& w) const;
+  std::ostream& write_ansi(std::ostream &out, const Word<N>& w) const;
 };
 
-std::ostream& operator<<(std::ostream& out, const Response &r);
+template<size_t N>
+std::ostream& operator<<(std::ostream& out, const Response<N> &r);
 
 // Gamestate
 // The public information at a given point in the game
+template<size_t N>
 class State {
+  static_assert(SupportedLength<N>, "Unsupported word length");
 public:
   State();
-  State(const State& s) : yellow(s.yellow), green(s.green) {}
 
   // Update the state to account for the guess and response
   // Returns false if the pair is nonsensical
   // Note: the internals are unpredictable if update returns false
   // Use an assert() or copy the State before calling.
-  bool update(const Word &w, const Response &r);
+  bool update(const Word<N> &w, const Response<N> &r);
 
   // Determine if the given word is a possible secret
-  bool matches(const Word &w) const;
+  bool matches(const Word<N> &w) const;
 
   // Returns the built-up green word, or nullopt if it's incomplete
-  std::optional<Word> final() const;
+  std::optional<Word<N>> final() const;
 
-  bool operator==(const State& s) const;
-  bool operator!=(const State& s) const;
+  bool operator==(const State& s) const = default;
+  bool operator!=(const State& s) const = default;
 
   std::ostream& serialize(std::ostream& out) const;
   static State deserialize(std::istream& in);
 private:
-  friend std::ostream& operator<<(std::ostream& out, const State& s);
-  struct Yellow {
-    uint8_t min : 2; // min occurrances of the letter
-    uint8_t strict : 1; // is the above constraint strict?
-    uint8_t indices : 5; // Bitset of the fields the letter is not
-  };
-  std::array<Yellow, 26> yellow;
-  Word green;
+  template<size_t M>
+  friend std::ostream& operator<<(std::ostream& out, const State<M>& s);
+  friend struct std::hash<State>;
+
+  // Minimum number of occurrences of each letter, as a 3-bit binary count
+  // split into bit planes (counts[k] holds bit k, with bit 0 of a plane being A)
+  // Three bits cover every count up to max_length
+  std::array<uint32_t, 3> counts;
+  // Letters that occur exactly their minimum number of times
+  uint32_t strict;
+  // Bitset of the letters allowed at each position
+  // A single letter is a green
+  std::array<uint32_t, N> allowed;
 };
 
-std::ostream& operator<<(std::ostream& out, const State& s);
+template<size_t N>
+std::ostream& operator<<(std::ostream& out, const State<N>& s);
+
+// The classes are only instantiated for the supported lengths
+#define WORDLE_EXTERN_TEMPLATES(N) \
+  extern template class Word<N>; \
+  extern template class Response<N>; \
+  extern template class State<N>; \
+  extern template std::ostream& operator<<(std::ostream&, const Word<N>&); \
+  extern template std::ostream& operator<<(std::ostream&, const Response<N>&); \
+  extern template std::ostream& operator<<(std::ostream&, const State<N>&);
+
+WORDLE_EXTERN_TEMPLATES(4)
+WORDLE_EXTERN_TEMPLATES(5)
+WORDLE_EXTERN_TEMPLATES(6)
+WORDLE_EXTERN_TEMPLATES(7)
+
+#undef WORDLE_EXTERN_TEMPLATES
 }
 
-template<>
-struct std::hash<wordle::Word> {
-    size_t operator()(const wordle::Word&) const noexcept;
+template<size_t N>
+struct std::hash<wordle::Word<N>> {
+    size_t operator()(const wordle::Word<N>&) const noexcept;
 };
 
-template<>
-struct std::hash<wordle::Response> {
-    size_t operator()(const wordle::Response&) const noexcept;
+template<size_t N>
+struct std::hash<wordle::Response<N>> {
+    size_t operator()(const wordle::Response<N>&) const noexcept;
 };
 
-template<>
-struct std::hash<wordle::State> {
-    size_t operator()(const wordle::State&) const noexcept;
+template<size_t N>
+struct std::hash<wordle::State<N>> {
+    size_t operator()(const wordle::State<N>&) const noexcept;
 };
+
+extern template struct std::hash<wordle::Word<4>>;
+extern template struct std::hash<wordle::Word<5>>;
+extern template struct std::hash<wordle::Word<6>>;
+extern template struct std::hash<wordle::Word<7>>;
+extern template struct std::hash<wordle::Response<4>>;
+extern template struct std::hash<wordle::Response<5>>;
+extern template struct std::hash<wordle::Response<6>>;
+extern template struct std::hash<wordle::Response<7>>;
+extern template struct std::hash<wordle::State<4>>;
+extern template struct std::hash<wordle::State<5>>;
+extern template struct std::hash<wordle::State<6>>;
+extern template struct std::hash<wordle::State<7>>;
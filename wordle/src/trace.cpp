@@ -0,0 +1,163 @@
+#include <trace.hpp>
+
+#ifdef WORDLE_TRACE
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace wordle::trace;
+
+namespace {
+struct Event {
+  const char *name;
+  uint64_t start;
+  uint64_t duration;
+};
+
+// Each thread appends to its own chains of chunks, one per level.
+// The owning thread is the only writer, and publishes each event
+// by bumping `size`, so flush() can read concurrently without locks.
+struct Chunk {
+  static constexpr size_t capacity = 1 << 14;
+  std::array<Event, capacity> events;
+  std::atomic<size_t> size{0};
+  std::atomic<Chunk*> next{nullptr};
+};
+
+// Upper bound on events per thread and level, so long runs don't exhaust memory
+constexpr size_t max_chunks = 256;
+
+struct Chain {
+  Chunk head;
+  Chunk *tail = &head;
+  size_t chunks = 1;
+  std::atomic<uint64_t> dropped{0};
+
+  ~Chain() {
+    Chunk *c = head.next.load();
+    while (c != nullptr) {
+      Chunk *next = c->next.load();
+      delete c;
+      c = next;
+    }
+  }
+
+  void record(const Event& e) {
+    size_t n = tail->size.load(std::memory_order_relaxed);
+    if (n == Chunk::capacity) {
+      if (chunks == max_chunks) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      auto c = new Chunk;
+      tail->next.store(c, std::memory_order_release);
+      tail = c;
+      chunks++;
+      n = 0;
+    }
+    tail->events[n] = e;
+    tail->size.store(n + 1, std::memory_order_release);
+  }
+};
+
+struct Buffer {
+  uint32_t tid;
+  // Indexed by Level
+  std::array<Chain, 2> chains;
+};
+
+// Buffers are registered once per thread and kept until exit,
+// so spans from finished threads are still flushed
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<Buffer>> registry;
+
+Buffer& local_buffer() {
+  thread_local Buffer *buffer = [] {
+    std::lock_guard lock(registry_mutex);
+    auto b = std::make_unique<Buffer>();
+    b->tid = static_cast<uint32_t>(registry.size());
+    registry.push_back(std::move(b));
+    return registry.back().get();
+  }();
+  return *buffer;
+}
+
+const auto epoch = std::chrono::steady_clock::now();
+
+uint64_t now() {
+  auto d = std::chrono::steady_clock::now() - epoch;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+void write_string(std::ostream& out, const char *s) {
+  out << '"';
+  for (; *s != '\0'; s++) {
+    if (*s == '"' || *s == '\\') {
+      out << '\\';
+    }
+    out << *s;
+  }
+  out << '"';
+}
+
+// Chrome expects microseconds
+void write_micros(std::ostream& out, uint64_t ns) {
+  out << ns / 1000 << '.';
+  auto frac = ns % 1000;
+  out << char('0' + frac / 100) << char('0' + frac / 10 % 10) << char('0' + frac % 10);
+}
+}
+
+Span::Span(const char *name, Level level) noexcept : name(name), start(now()), level(level) {}
+
+Span::~Span() {
+  local_buffer().chains[static_cast<size_t>(level)].record(Event{name, start, now() - start});
+}
+
+void wordle::trace::flush(std::ostream& out) {
+  std::lock_guard lock(registry_mutex);
+  out << "{\"traceEvents\":[\n";
+  bool first = true;
+  auto separator = [&] {
+    if (!first) {
+      out << ",\n";
+    }
+    first = false;
+  };
+  for (const auto& b : registry) {
+    separator();
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+        << ",\"args\":{\"name\":\"thread " << b->tid << "\"}}";
+    for (const auto& chain : b->chains) {
+      for (const Chunk *c = &chain.head; c != nullptr; c = c->next.load(std::memory_order_acquire)) {
+        size_t n = c->size.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; i++) {
+          const auto& e = c->events[i];
+          separator();
+          out << "{\"name\":";
+          write_string(out, e.name);
+          out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid << ",\"ts\":";
+          write_micros(out, e.start);
+          out << ",\"dur\":";
+          write_micros(out, e.duration);
+          out << "}";
+        }
+      }
+    }
+    for (size_t level = 0; level < b->chains.size(); level++) {
+      if (auto dropped = b->chains[level].dropped.load(); dropped != 0) {
+        std::clog << "trace: thread " << b->tid << " dropped " << dropped
+                  << (level == static_cast<size_t>(Level::LEAF) ? " leaf" : "") << " spans\n";
+      }
+    }
+  }
+  out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+#endif
@@ -6,46 +6,136 @@
 #include <iostream>
 #include <optional>
 #include <cstring>
+#include <utility>
 #include <wordle.hpp>
+#include <trace.hpp>
 
 using namespace wordle;
 
-Word::Word() {
-    std::fill(begin(), end(), 0xff);
+namespace {
+// Calls f(0), f(1), ..., f(N - 1) with compile-time indices
+// Used in the per-letter kernels so each word length is fully unrolled
+template<size_t N, typename F>
+inline void unroll(F&& f) {
+  [&]<size_t... I>(std::index_sequence<I...>) {
+    (f(std::integral_constant<size_t, I>{}), ...);
+  }(std::make_index_sequence<N>{});
 }
 
-Word::Word(const char *word) {
-  for (auto &c : *this) {
-    if (*word < 'A' || 'Z' < *word) {
+// Same as above, but stops early once f returns false
+template<size_t N, typename F>
+inline bool unroll_all(F&& f) {
+  return [&]<size_t... I>(std::index_sequence<I...>) {
+    return (f(std::integral_constant<size_t, I>{}) && ...);
+  }(std::make_index_sequence<N>{});
+}
+
+constexpr uint32_t all_letters = (1u << 26) - 1;
+
+// How many times each letter occurs, as a 3-bit binary count
+// split into bit planes: bits[k] holds bit k of every letter's count
+struct Planes {
+  std::array<uint32_t, 3> bits{};
+
+  void add(uint32_t letter) {
+    uint32_t carry = letter;
+    for (auto& b : bits) {
+      uint32_t next = b & carry;
+      b ^= carry;
+      carry = next;
+    }
+  }
+
+  // Letters that occur at all
+  uint32_t any() const { return bits[0] | bits[1] | bits[2]; }
+
+  unsigned count(uint32_t letter) const {
+    return ((bits[0] & letter) != 0) | ((bits[1] & letter) != 0) << 1 | ((bits[2] & letter) != 0) << 2;
+  }
+
+  void set(uint32_t letter, unsigned n) {
+    for (size_t k = 0; k < bits.size(); k++) {
+      bits[k] = (bits[k] & ~letter) | ((n >> k) & 1 ? letter : 0);
+    }
+  }
+};
+
+// Letters that occur more often in `a` than in `b`
+// Compares every letter's count at once, from the top bit down
+uint32_t more(const Planes& a, const Planes& b) {
+  uint32_t greater = 0;
+  uint32_t equal = all_letters;
+  for (size_t k = a.bits.size(); k-- > 0;) {
+    greater |= equal & a.bits[k] & ~b.bits[k];
+    equal &= ~(a.bits[k] ^ b.bits[k]);
+  }
+  return greater;
+}
+
+// The larger count of each letter
+Planes max(const Planes& a, const Planes& b) {
+  uint32_t larger = more(b, a);
+  Planes m;
+  for (size_t k = 0; k < m.bits.size(); k++) {
+    m.bits[k] = (a.bits[k] & ~larger) | (b.bits[k] & larger);
+  }
+  return m;
+}
+}
+
+template<size_t N>
+Word<N>::Word() : letters(0) {
+  unroll<N>([&](auto i) {
+    letters |= bits_t(blank) << (5 * i);
+  });
+}
+
+template<size_t N>
+Word<N>::Word(const char *word) : letters(0) {
+  for (size_t i = 0; i < N; i++) {
+    if (word[i] < 'A' || 'Z' < word[i]) {
       throw new std::runtime_error("Invalid word");
     }
-    c = *word++ - 'A';
+    letters |= bits_t(word[i] - 'A') << (5 * i);
   }
 }
 
-std::ostream& wordle::operator<<(std::ostream& out, const Word& w) {
-  for (uint8_t i : w) {
-    if (i == 0xff) {
+template<size_t N>
+void Word<N>::set(size_t i, uint8_t c) {
+  letters &= ~(bits_t(0x1f) << (5 * i));
+  letters |= bits_t(c) << (5 * i);
+}
+
+template<size_t N>
+std::ostream& wordle::operator<<(std::ostream& out, const Word<N>& w) {
+  for (size_t i = 0; i < N; i++) {
+    if (w[i] == Word<N>::blank) {
       out << '_';
     } else {
-      out << char('A' + i);
+      out << char('A' + w[i]);
     }
   }
   return out;
 }
 
-std::ostream& Word::serialize(std::ostream& out) const {
-    std::array<char, sizeof(Word)> buf;
-    std::memcpy(buf.data(), this, sizeof(Word));
+template<size_t N>
+std::ostream& Word<N>::serialize(std::ostream& out) const {
+    std::array<char, sizeof(bits_t)> buf;
+    std::memcpy(buf.data(), &letters, buf.size());
     out.write(buf.data(), buf.size());
     return out;
 }
 
-Word Word::deserialize(std::istream& in) {
-    std::array<char, sizeof(Word)> buf;
+template<size_t N>
+Word<N> Word<N>::deserialize(std::istream& in) {
+    std::array<char, sizeof(bits_t)> buf;
     in.read(buf.data(), buf.size());
+    bits_t letters;
+    std::memcpy(&letters, buf.data(), buf.size());
     Word w;
-    std::memcpy(&w, buf.data(), buf.size());
+    for (size_t i = 0; i < N; i++) {
+      w.set(i, (letters >> (5 * i)) & 0x1f);
+    }
     return w;
 }
 
@@ -64,19 +154,42 @@ std::ostream& wordle::operator<<(std::ostream& out, Color c) {
   return out;
 }
 
-std::ostream& wordle::operator<<(std::ostream& out, const Response &r) {
+template<size_t N>
+std::ostream& wordle::operator<<(std::ostream& out, const Response<N> &r) {
   for (auto c : r) {
     out << c;
   }
   return out;
 }
 
-Response::Response() {
-  std::fill(begin(), end(), Color::GRAY);
+template<size_t N>
+Response<N>::Response() {
+  std::fill(this->begin(), this->end(), Color::GRAY);
 }
 
-bool Response::next_combination() {
-  for (auto it = rbegin(); it != rend(); it++) {
+template<size_t N>
+Response<N> Response<N>::score(const Word<N>& guess, const Word<N>& secret) {
+  Response r;
+  std::array<uint8_t, 26> s_occurs{};
+  unroll<N>([&](auto i) {
+    if (secret[i] == guess[i]) {
+      r[i] = Color::GREEN;
+    } else {
+      s_occurs[secret[i]]++;
+    }
+  });
+  unroll<N>([&](auto i) {
+    if (r[i] == Color::GRAY && s_occurs[guess[i]] > 0) {
+      s_occurs[guess[i]]--;
+      r[i] = Color::YELLOW;
+    }
+  });
+  return r;
+}
+
+template<size_t N>
+bool Response<N>::next_combination() {
+  for (auto it = this->rbegin(); it != this->rend(); it++) {
     switch (*it) {
       case Color::GRAY:
         *it = Color::YELLOW;
@@ -92,10 +205,30 @@ bool Response::next_combination() {
   return false;
 }
 
-std::ostream& Response::write_ansi(std::ostream &out, const Word& w) const {
+template<size_t N>
+uint16_t Response<N>::code() const {
+  uint16_t code = 0;
+  unroll<N>([&](auto i) {
+    code = code * 3 + static_cast<uint16_t>((*this)[i]);
+  });
+  return code;
+}
+
+template<size_t N>
+Response<N> Response<N>::from_code(uint16_t code) {
+  Response r;
+  for (size_t i = N; i-- > 0;) {
+    r[i] = static_cast<Color>(code % 3);
+    code /= 3;
+  }
+  return r;
+}
+
+template<size_t N>
+std::ostream& Response<N>::write_ansi(std::ostream &out, const Word<N>& w) const {
   for (size_t i = 0; i < w.size(); i++) {
     const char *code = "";
-    switch (at(i)) {
+    switch (this->at(i)) {
       case Color::GRAY:
         code = "246";
         break;
@@ -112,196 +245,214 @@ std::ostream& Response::write_ansi(std::ostream &out, const Word& w) const {
   return out;
 }
 
-State::State() : yellow(), green() {
-  for (auto g : green) {
-    assert(g == 0xff);
-  }
+template<size_t N>
+State<N>::State() : counts{}, strict(0) {
+  allowed.fill(all_letters);
 }
 
-bool State::update(const Word &w, const Response &r) {
-  std::array<uint8_t, 26> w_occurs{};
-  std::array<uint8_t, 26> k_occurs{};
-
-  // Initialize arrays
-  // w_occurs maps letters to how many times they appear in the guess
-  // k_occurs maps letters to how many times they appear in the response (yellow or green)
-  for (size_t i = 0; i < w.size(); i++) {
-    w_occurs[w[i]]++;
+template<size_t N>
+bool State<N>::update(const Word<N> &w, const Response<N> &r) {
+  WORDLE_TRACE_LEAF_SPAN("State::update");
+  // guessed counts how many times letters appear in the guess
+  // known counts how many times letters appear in the response (yellow or green)
+  Planes guessed;
+  Planes known;
+  unroll<N>([&](auto i) {
+    uint32_t letter = 1u << w[i];
+    guessed.add(letter);
     if (r[i] != Color::GRAY) {
-      k_occurs[w[i]]++;
+      known.add(letter);
     }
-    if (w[i] == green[i] && r[i] != Color::GREEN) {
-      // Response and guess are incompatible
-      return false;
+    if (r[i] == Color::GREEN) {
+      allowed[i] &= letter;
+    } else {
+      // If yellow or gray, character cannot appear at that index
+      allowed[i] &= ~letter;
     }
+  });
+
+  Planes min{counts};
+  uint32_t exact = strict;
+
+  // Letter occurs more in guess than response: strict bound
+  uint32_t bounded = more(guessed, known);
+  if ((bounded & more(min, known)) != 0 || (exact & more(known, min)) != 0) {
+    // Attempt to set a strict bound when there is already a larger minimum,
+    // or a larger minimum when there is already a strict bound!
+    return false;
   }
+  min = max(min, known);
+  exact |= bounded;
 
-  for (size_t i = 0; i < w.size(); i++) {
-    // Set minimum occurance for w[i]
-    if (w_occurs[w[i]] > k_occurs[w[i]]) {
-      // Letter occurs more in guess than response: strict bound
-      if (yellow[w[i]].min > k_occurs[w[i]]) {
-        // Attempt to set a strict bound when there is already a larger minimum!
-        return false;
-      }
-      yellow[w[i]].strict = true;
-      yellow[w[i]].min = k_occurs[w[i]];
-      if (k_occurs[w[i]] == 0) {
-        yellow[w[i]].indices = 0x1f;
+  // Deduce colors until nothing changes
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    // Letters with a strict bound of zero can't be anywhere
+    uint32_t absent = exact & ~min.any();
+    uint32_t greens = 0;
+    bool possible = unroll_all<N>([&](auto i) {
+      allowed[i] &= ~absent;
+      if (std::has_single_bit(allowed[i])) {
+        greens |= allowed[i];
       }
-    } else {
-      // Letter occurs equal in guess and response: weak bound
-      yellow[w[i]].min = std::max(yellow[w[i]].min, k_occurs[w[i]]);
+      return allowed[i] != 0;
+    });
+    if (!possible) {
+      // Conflicting green outputs
+      return false;
     }
 
-    switch (r[i]) {
-      case Color::GRAY:
-        // Already handled by above
-        break;
-      case Color::YELLOW:
-        // If yellow, character cannot appear at that index
-        yellow[w[i]].indices |= 1 << i;
-        break;
-      case Color::GREEN:
-        // If green, set the output and possibly update bounds
-        if (green[i] == w[i]) {
-          // Green already set
-          break;
-        }
-        if (green[i] != 0xff) {
-          // Conflicting green outputs
+    for (uint32_t letters = min.any() | greens; letters != 0; letters &= letters - 1) {
+      uint32_t letter = letters & -letters;
+      unsigned places = 0;
+      unsigned green = 0;
+      unroll<N>([&](auto i) {
+        places += (allowed[i] & letter) != 0;
+        green += allowed[i] == letter;
+      });
+
+      // There can't be less than 2 'A's if there are two green 'A's
+      unsigned count = min.count(letter);
+      if (green > count) {
+        if (exact & letter) {
           return false;
         }
-        green[i] = w[i];
-
-        uint8_t occurs = std::count_if(
-          green.begin(),
-          green.end(),
-          [k=w[i]](uint8_t c) { return c == k; });
-        // There can't be less than 2 'A's if there are two green 'A's
-        yellow[w[i]].min = std::max(yellow[w[i]].min, occurs);
+        min.set(letter, green);
+        count = green;
+      }
+      if (places < count) {
+        return false;
+      }
+
+      if (places == count && green < places) {
+        // Ex. EERIE -> YY___, so E: XX__X 2+
+        // Therefore word must have __EE__
+        unroll<N>([&](auto i) {
+          if (allowed[i] & letter) {
+            allowed[i] = letter;
+          }
+        });
+        changed = true;
+      } else if ((exact & letter) && green == count && places > green) {
         // If there was a strict bound on a letter and they're all guessed, remove the others
         // Ex. EERIE -> YY___ (This sets E strict bound 2); FLEES -> __GG_
-        // We would update 'E' from YY___ to YY__Y since we got all the 
-        if (yellow[w[i]].strict && occurs == yellow[w[i]].min) {
-          for (size_t j = 0; j < green.size(); j++) {
-            if (green[j] != w[i]) {
-              yellow[w[i]].indices |= 1 << j;
-            }
+        // We would update 'E' from YY___ to YY__Y since we got all the E's
+        unroll<N>([&](auto i) {
+          if (allowed[i] != letter) {
+            allowed[i] &= ~letter;
           }
-        }
-        break;
-    }
-  }
-
-  // Deduce colors
-  for (uint8_t i = 0; i < 26; i++) {
-    // Ex. EERIE -> YY___, so E: XX__X 2+
-    // Therefore word must have __EE__
-    if (5 - yellow[i].min == std::popcount(yellow[i].indices)) {
-      for (uint8_t j = 0; j < green.size(); j++) {
-        if ((yellow[i].indices & (1 << j)) == 0) {
-          green[j] = i;
-        }
+        });
+        changed = true;
       }
     }
   }
+
+  counts = min.bits;
+  strict = exact;
   return true;
 }
 
-bool State::matches(const Word &w) const {
-  // All greens match
-  for (size_t i = 0; i < w.size(); i++) {
-    if (green[i] != 0xff && green[i] != w[i]) {
-      return false;
-    }
-  }
-
-  // No yellows match
-  for (size_t i = 0; i < w.size(); i++) {
-    if (yellow[w[i]].indices & (1 << i)) {
-      return false;
-    }
+template<size_t N>
+bool State<N>::matches(const Word<N> &w) const {
+  WORDLE_TRACE_LEAF_SPAN("State::matches");
+  // All greens match, and no yellows match
+  bool positions = unroll_all<N>([&](auto i) {
+    return (allowed[i] >> w[i]) & 1;
+  });
+  if (!positions) {
+    return false;
   }
 
   // Each occurrance is compatible
-  std::array<uint8_t, 26> occurs{};
-  for (size_t i = 0; i < w.size(); i++) {
-    occurs[w[i]]++;
-  }
-  for (uint8_t i = 0; i < 26; i++) {
-    if (occurs[i] < yellow[i].min || (occurs[i] > yellow[i].min && yellow[i].strict)) {
-      return false;
-    }
-  }
-  return true;
+  Planes occurs;
+  unroll<N>([&](auto i) {
+    occurs.add(1u << w[i]);
+  });
+  Planes min{counts};
+  return more(min, occurs) == 0 && (more(occurs, min) & strict) == 0;
 }
 
-std::optional<Word> State::final() const {
-  if (std::any_of(green.begin(), green.end(), [](uint8_t c) { return c == 0xff; })) {
-    return std::nullopt;
+template<size_t N>
+std::optional<Word<N>> State<N>::final() const {
+  Word<N> w;
+  for (size_t i = 0; i < N; i++) {
+    if (!std::has_single_bit(allowed[i])) {
+      return std::nullopt;
+    }
+    w.set(i, std::countr_zero(allowed[i]));
   }
-  return green;
+  return w;
 }
 
-bool State::operator==(const State& s) const {
-    return std::memcmp(yellow.data(), s.yellow.data(), sizeof yellow) == 0
-        && green == s.green;
-}
-
-bool State::operator!=(const State& s) const {
-    return !(*this == s);
-}
-
-std::ostream& State::serialize(std::ostream& out) const {
-    std::array<char, sizeof(State)> buf;
-    std::memcpy(buf.data(), this, buf.size());
+template<size_t N>
+std::ostream& State<N>::serialize(std::ostream& out) const {
+    std::array<char, sizeof counts + sizeof strict + sizeof allowed> buf;
+    std::memcpy(buf.data(), counts.data(), sizeof counts);
+    std::memcpy(buf.data() + sizeof counts, &strict, sizeof strict);
+    std::memcpy(buf.data() + sizeof counts + sizeof strict, allowed.data(), sizeof allowed);
     out.write(buf.data(), buf.size());
     return out;
 }
 
-State State::deserialize(std::istream& in) {
-    std::array<char, sizeof(State)> buf;
-    in.read(buf.data(), buf.size());
+template<size_t N>
+State<N> State<N>::deserialize(std::istream& in) {
     State s;
-    std::memcpy(&s, buf.data(), buf.size());
+    std::array<char, sizeof s.counts + sizeof s.strict + sizeof s.allowed> buf;
+    in.read(buf.data(), buf.size());
+    std::memcpy(s.counts.data(), buf.data(), sizeof s.counts);
+    std::memcpy(&s.strict, buf.data() + sizeof s.counts, sizeof s.strict);
+    std::memcpy(s.allowed.data(), buf.data() + sizeof s.counts + sizeof s.strict, sizeof s.allowed);
     return s;
 }
 
-std::ostream& wordle::operator<<(std::ostream& out, const State& s) {
+template<size_t N>
+std::ostream& wordle::operator<<(std::ostream& out, const State<N>& s) {
+  Planes min{s.counts};
+  Word<N> green;
+  for (size_t j = 0; j < N; j++) {
+    if (std::has_single_bit(s.allowed[j])) {
+      green.set(j, std::countr_zero(s.allowed[j]));
+    }
+  }
+
   for (uint8_t i = 0; i < 26; i++) {
-    if (s.yellow[i].indices == 0 && s.yellow[i].min == 0) {
+    uint32_t letter = 1u << i;
+    // Greens of other letters are shown in the green word instead
+    bool excluded = false;
+    for (size_t j = 0; j < N; j++) {
+      excluded |= (s.allowed[j] & letter) == 0 && green[j] == Word<N>::blank;
+    }
+    if (!excluded && (min.any() & letter) == 0) {
       continue;
     }
     out << char('A' + i) << " ";
-    for (size_t j = 0; j < 5; j++) {
-      if (s.yellow[i].indices & (1 << j)) {
+    for (size_t j = 0; j < N; j++) {
+      if ((s.allowed[j] & letter) == 0 && green[j] == Word<N>::blank) {
         out << 'X';
       } else {
         out << '_';
       }
     }
-    out << " " << int(s.yellow[i].min);
-    if (!s.yellow[i].strict) {
+    out << " " << min.count(letter);
+    if ((s.strict & letter) == 0) {
       out << "+";
     }
     out << std::endl;
   }
 
-  out << "  " << s.green;
+  out << "  " << green;
   return out;
 }
 
-size_t std::hash<Word>::operator()(const Word& w) const noexcept {
-    size_t h = 0;
-    std::hash<uint8_t> hasher;
-    for (auto c : w) {
-        h ^= hasher(static_cast<uint8_t>(c)) + 0x9e3779b9 + (h << 6) + (h >> 2);
-    }
-    return h;
+template<size_t N>
+size_t std::hash<Word<N>>::operator()(const Word<N>& w) const noexcept {
+    return std::hash<typename Word<N>::bits_t>{}(w.bits());
 }
 
-size_t std::hash<Response>::operator()(const Response& r) const noexcept {
+template<size_t N>
+size_t std::hash<Response<N>>::operator()(const Response<N>& r) const noexcept {
     size_t h = 0;
     std::hash<uint8_t> hasher;
     for (auto c : r) {
@@ -310,13 +461,38 @@ size_t std::hash<Response>::operator()(const Response& r) const noexcept {
     return h;
 }
 
-size_t std::hash<State>::operator()(const State& s) const noexcept {
-    std::array<char, sizeof(State)> buf;
-    std::memcpy(buf.data(), &s, sizeof buf);
+template<size_t N>
+size_t std::hash<State<N>>::operator()(const State<N>& s) const noexcept {
     size_t h = 0;
-    std::hash<char> hasher;
-    for (auto c : buf) {
-        h ^= hasher(c) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    std::hash<uint64_t> hasher;
+    auto combine = [&](uint64_t x) {
+        h ^= hasher(x) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    };
+    combine(s.counts[0] | uint64_t(s.counts[1]) << 32);
+    combine(s.counts[2] | uint64_t(s.strict) << 32);
+    for (size_t i = 0; i < N; i += 2) {
+        uint64_t lanes = s.allowed[i];
+        if (i + 1 < N) {
+            lanes |= uint64_t(s.allowed[i + 1]) << 32;
+        }
+        combine(lanes);
     }
     return h;
 }
+
+// Explicit instantiations for every supported length
+#define WORDLE_INSTANTIATE(N) \
+  template class wordle::Word<N>; \
+  template class wordle::Response<N>; \
+  template class wordle::State<N>; \
+  template std::ostream& wordle::operator<<(std::ostream&, const Word<N>&); \
+  template std::ostream& wordle::operator<<(std::ostream&, const Response<N>&); \
+  template std::ostream& wordle::operator<<(std::ostream&, const State<N>&); \
+  template struct std::hash<Word<N>>; \
+  template struct std::hash<Response<N>>; \
+  template struct std::hash<State<N>>;
+
+WORDLE_INSTANTIATE(4)
+WORDLE_INSTANTIATE(5)
+WORDLE_INSTANTIATE(6)
+WORDLE_INSTANTIATE(7)
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <wordle.hpp>
+#include <wordle.h>
+
+using namespace wordle;
+
+namespace {
+// Layout of wordle_state: the length, followed by the State<N>
+struct Header {
+  uint64_t length;
+};
+
+constexpr size_t state_offset = sizeof(Header);
+
+static_assert(sizeof(Header) + sizeof(State<max_length>) <= sizeof(wordle_state),
+              "wordle_state is too small");
+
+template<size_t N>
+State<N> *get_state(wordle_state *s) {
+  return std::launder(reinterpret_cast<State<N>*>(
+    reinterpret_cast<unsigned char*>(s->opaque) + state_offset));
+}
+
+template<size_t N>
+const State<N> *get_state(const wordle_state *s) {
+  return std::launder(reinterpret_cast<const State<N>*>(
+    reinterpret_cast<const unsigned char*>(s->opaque) + state_offset));
+}
+
+bool has_length(const wordle_state *s, size_t length) {
+  Header h;
+  std::memcpy(&h, s->opaque, sizeof h);
+  return h.length == length;
+}
+
+// Parses one packed ASCII word without throwing
+template<size_t N>
+bool parse(const char *ascii, Word<N>& w) {
+  for (size_t i = 0; i < N; i++) {
+    if (ascii[i] < 'A' || 'Z' < ascii[i]) {
+      return false;
+    }
+  }
+  w = Word<N>(ascii);
+  return true;
+}
+
+template<size_t N>
+wordle_status state_init(wordle_state *states, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    Header h{N};
+    std::memcpy(states[i].opaque, &h, sizeof h);
+    new (reinterpret_cast<unsigned char*>(states[i].opaque) + state_offset) State<N>();
+  }
+  return WORDLE_OK;
+}
+
+template<size_t N>
+wordle_status score(const char *guesses, size_t n_guesses,
+                    const char *answers, size_t n_answers,
+                    uint16_t *codes) {
+  // Answers are parsed in blocks that stay in cache across all guesses
+  constexpr size_t block = 256;
+  std::array<Word<N>, block> parsed;
+  for (size_t a0 = 0; a0 < n_answers; a0 += block) {
+    size_t n = std::min(block, n_answers - a0);
+    for (size_t a = 0; a < n; a++) {
+      if (!parse<N>(answers + (a0 + a) * N, parsed[a])) {
+        return WORDLE_INVALID_WORD;
+      }
+    }
+    for (size_t g = 0; g < n_guesses; g++) {
+      Word<N> guess;
+      if (!parse<N>(guesses + g * N, guess)) {
+        return WORDLE_INVALID_WORD;
+      }
+      uint16_t *row = codes + g * n_answers + a0;
+      for (size_t a = 0; a < n; a++) {
+        row[a] = Response<N>::score(guess, parsed[a]).code();
+      }
+    }
+  }
+  return WORDLE_OK;
+}
+
+template<size_t N>
+wordle_status filter(const wordle_state *state, const char *words, size_t n_words,
+                     uint8_t *matches, size_t *n_matches) {
+  const State<N>& s = *get_state<N>(state);
+  size_t count = 0;
+  for (size_t i = 0; i < n_words; i++) {
+    Word<N> w;
+    if (!parse<N>(words + i * N, w)) {
+      return WORDLE_INVALID_WORD;
+    }
+    bool m = s.matches(w);
+    matches[i] = m;
+    count += m;
+  }
+  if (n_matches != nullptr) {
+    *n_matches = count;
+  }
+  return WORDLE_OK;
+}
+
+template<size_t N>
+wordle_status update(wordle_state *states, const char *guesses, const uint16_t *codes,
+                     size_t count, uint8_t *ok) {
+  // The whole batch is checked first, so an error leaves every state untouched
+  for (size_t i = 0; i < count; i++) {
+    if (!has_length(&states[i], N) || codes[i] >= Response<N>::combinations) {
+      return WORDLE_INVALID_ARGUMENT;
+    }
+    Word<N> w;
+    if (!parse<N>(guesses + i * N, w)) {
+      return WORDLE_INVALID_WORD;
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    State<N>& s = *get_state<N>(&states[i]);
+    State<N> next = s;
+    bool valid = next.update(Word<N>(guesses + i * N), Response<N>::from_code(codes[i]));
+    if (valid) {
+      s = next;
+    }
+    if (ok != nullptr) {
+      ok[i] = valid;
+    }
+  }
+  return WORDLE_OK;
+}
+
+// Calls f.template operator()<N>() for the runtime length,
+// without letting any exception cross the C boundary
+template<typename F>
+wordle_status dispatch(size_t length, F&& f) noexcept {
+  try {
+    switch (length) {
+      case 4: return f.template operator()<4>();
+      case 5: return f.template operator()<5>();
+      case 6: return f.template operator()<6>();
+      case 7: return f.template operator()<7>();
+      default: return WORDLE_UNSUPPORTED_LENGTH;
+    }
+  } catch (...) {
+    return WORDLE_INTERNAL_ERROR;
+  }
+}
+}
+
+uint32_t wordle_abi_version(void) {
+  return WORDLE_ABI_VERSION;
+}
+
+wordle_status wordle_state_init(size_t length, wordle_state *states, size_t count) {
+  if (states == nullptr && count != 0) {
+    return WORDLE_INVALID_ARGUMENT;
+  }
+  return dispatch(length, [&]<size_t N>() {
+    return state_init<N>(states, count);
+  });
+}
+
+wordle_status wordle_score(size_t length,
+                           const char *guesses, size_t n_guesses,
+                           const char *answers, size_t n_answers,
+                           uint16_t *codes) {
+  if ((guesses == nullptr && n_guesses != 0)
+      || (answers == nullptr && n_answers != 0)
+      || (n_answers != 0 && n_guesses > SIZE_MAX / n_answers)
+      || (codes == nullptr && n_guesses * n_answers != 0)) {
+    return WORDLE_INVALID_ARGUMENT;
+  }
+  return dispatch(length, [&]<size_t N>() {
+    return score<N>(guesses, n_guesses, answers, n_answers, codes);
+  });
+}
+
+wordle_status wordle_filter(size_t length, const wordle_state *state,
+                            const char *words, size_t n_words,
+                            uint8_t *matches, size_t *n_matches) {
+  if (state == nullptr || ((words == nullptr || matches == nullptr) && n_words != 0)) {
+    return WORDLE_INVALID_ARGUMENT;
+  }
+  if (!has_length(state, length)) {
+    return length < min_length || max_length < length
+      ? WORDLE_UNSUPPORTED_LENGTH
+      : WORDLE_INVALID_ARGUMENT;
+  }
+  return dispatch(length, [&]<size_t N>() {
+    return filter<N>(state, words, n_words, matches, n_matches);
+  });
+}
+
+wordle_status wordle_update(size_t length, wordle_state *states,
+                            const char *guesses, const uint16_t *codes, size_t count,
+                            uint8_t *ok) {
+  if ((states == nullptr || guesses == nullptr || codes == nullptr) && count != 0) {
+    return WORDLE_INVALID_ARGUMENT;
+  }
+  return dispatch(length, [&]<size_t N>() {
+    return update<N>(states, guesses, codes, count, ok);
+  });
+}
@@ -0,0 +1,70 @@
+/* Smoke test for the C interface, compiled as C99 against wordle_c.
+ * Catches C-incompatible changes to wordle.h as well as broken exports. */
+
+#include <stdio.h>
+#include <string.h>
+#include <wordle.h>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+int main(void) {
+  wordle_state states[2];
+  wordle_state before[2];
+  uint16_t codes[4];
+  uint8_t ok[2];
+  uint8_t matches[3];
+  size_t n_matches = 0;
+
+  CHECK(wordle_abi_version() == WORDLE_ABI_VERSION);
+  CHECK(wordle_state_init(5, states, 2) == WORDLE_OK);
+
+  /* CRANE against REACT is YYG_Y, against CRANE all green */
+  CHECK(wordle_score(5, "CRANE", 1, "REACTCRANE", 2, codes) == WORDLE_OK);
+  CHECK(codes[0] == 1 * 81 + 1 * 27 + 2 * 9 + 0 * 3 + 1);
+  CHECK(codes[1] == 242);
+
+  CHECK(wordle_update(5, states, "CRANECRANE", codes, 2, ok) == WORDLE_OK);
+  CHECK(ok[0] == 1 && ok[1] == 1);
+
+  CHECK(wordle_filter(5, &states[0], "REACTCRANETRACE", 3, matches, &n_matches) == WORDLE_OK);
+  CHECK(matches[0] == 1 && matches[1] == 0 && matches[2] == 0);
+  CHECK(n_matches == 1);
+  CHECK(wordle_filter(5, &states[1], "REACTCRANETRACE", 3, matches, &n_matches) == WORDLE_OK);
+  CHECK(matches[0] == 0 && matches[1] == 1 && matches[2] == 0);
+
+  /* A nonsensical response leaves the state alone */
+  memcpy(before, states, sizeof states);
+  codes[0] = 242;
+  CHECK(wordle_update(5, states, "TRACE", codes, 1, ok) == WORDLE_OK);
+  CHECK(ok[0] == 0);
+  CHECK(memcmp(before, states, sizeof states) == 0);
+
+  /* Error paths: nothing is applied */
+  CHECK(wordle_score(3, "CRA", 1, "CRA", 1, codes) == WORDLE_UNSUPPORTED_LENGTH);
+  CHECK(wordle_score(5, "crane", 1, "REACT", 1, codes) == WORDLE_INVALID_WORD);
+  CHECK(wordle_filter(6, &states[0], "CRANES", 1, matches, NULL) == WORDLE_INVALID_ARGUMENT);
+  CHECK(wordle_filter(5, &states[0], "react", 1, matches, NULL) == WORDLE_INVALID_WORD);
+  codes[0] = 0;
+  codes[1] = 0;
+  CHECK(wordle_update(5, states, "SLATEslate", codes, 2, NULL) == WORDLE_INVALID_WORD);
+  CHECK(wordle_update(6, states, "SLATESSLATES", codes, 2, NULL) == WORDLE_INVALID_ARGUMENT);
+  codes[1] = 243;
+  CHECK(wordle_update(5, states, "SLATESLATE", codes, 2, NULL) == WORDLE_INVALID_ARGUMENT);
+  CHECK(memcmp(before, states, sizeof states) == 0);
+  CHECK(wordle_state_init(8, states, 1) == WORDLE_UNSUPPORTED_LENGTH);
+  CHECK(wordle_score(5, NULL, 1, "CRANE", 1, codes) == WORDLE_INVALID_ARGUMENT);
+
+  if (failures != 0) {
+    fprintf(stderr, "%d failures\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+// Checks State against Response::score: after any history of real
+// responses, a word must match the state exactly when it would have
+// given the same responses as the secret.
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include <wordle.hpp>
+
+using namespace wordle;
+
+namespace {
+int failures = 0;
+
+template<size_t N>
+void check(bool ok, const State<N>& s, const Word<N>& w, const char *what) {
+  if (!ok && failures++ < 10) {
+    std::cerr << what << ": " << w << " in state\n" << s << std::endl;
+  }
+}
+
+// Applies each guess scored against the secret, then checks the candidate
+template<size_t N>
+void check_history(const std::vector<Word<N>>& guesses, const Word<N>& secret, const Word<N>& candidate) {
+  State<N> s;
+  bool consistent = true;
+  for (const auto& g : guesses) {
+    auto r = Response<N>::score(g, secret);
+    check(s.update(g, r), s, g, "update rejected a real response");
+    consistent &= Response<N>::score(g, candidate) == r;
+  }
+  check(s.matches(secret), s, secret, "secret doesn't match");
+  check(s.matches(candidate) == consistent, s, candidate,
+        consistent ? "consistent word doesn't match" : "inconsistent word matches");
+}
+
+// Random histories over a few letters, so repeated letters are common
+template<size_t N>
+void check_random(std::mt19937& rng, int histories) {
+  std::uniform_int_distribution<int> letter(0, N - 1);
+  std::uniform_int_distribution<int> length(1, 4);
+  auto word = [&] {
+    std::array<char, N> ascii;
+    for (auto& c : ascii) {
+      c = char('A' + letter(rng));
+    }
+    return Word<N>(ascii.data());
+  };
+  for (int i = 0; i < histories; i++) {
+    std::vector<Word<N>> guesses(length(rng));
+    for (auto& g : guesses) {
+      g = word();
+    }
+    auto secret = word();
+    for (int j = 0; j < 20; j++) {
+      check_history<N>(guesses, secret, word());
+    }
+  }
+}
+}
+
+int main() {
+  // Letters occurring four or more times
+  check_history<5>({"BBBBD"}, "BBABB", "BBCBB");
+  check_history<6>({"ASSESS"}, "TASSES", "SASSES");
+  check_history<7>({"SSSSSSS"}, "POSSESS", "SOSSESS");
+  check_history<7>({"POSSESS", "SSSSSSS"}, "SESSSSS", "SSSSSSS");
+
+  std::mt19937 rng(12345);
+  check_random<4>(rng, 5000);
+  check_random<5>(rng, 5000);
+  check_random<6>(rng, 5000);
+  check_random<7>(rng, 5000);
+
+  if (failures != 0) {
+    std::cerr << failures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}